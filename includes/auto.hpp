@@ -0,0 +1,66 @@
+#ifndef AUTO_HPP
+#define AUTO_HPP
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include "bench.hpp"
+#include "cache_info.h"
+#include "matrix.hpp"
+
+namespace matmul {
+    // Largest multiple of a cache line (in elements) with three square tiles in L1D;
+    // 64 when the cache size is unknown
+    int block_size_for(const CacheInfo& info, int element_size = sizeof(int));
+
+    struct AutoPlan {
+        Algorithm algorithm;
+        int block_size;
+        int num_threads;
+        double predicted_ms;
+    };
+
+    // Picks an engine, tile size and thread count from an analytic cost model (measured
+    // tile kernel throughput and fork-join overhead, cache sizes, cores), then
+    // refines it with the timings it observes. Each (log2 m, log2 k, log2 n) bucket and
+    // engine keeps an EWMA of observed / predicted time that scales later predictions.
+    // An engine that has never run in a bucket is tried once when its prediction is
+    // within EXPLORE_RATIO of the best. Safe to share between threads.
+    class AutoTuner {
+        private:
+            using Bucket = std::tuple<int, int, int>;
+            struct Feedback {
+                double ratio = 1.0; // EWMA of observed / predicted
+                int samples = 0;
+            };
+
+            CacheInfo m_info;
+            int m_max_threads;
+            int m_block_size;
+            std::map<std::pair<Bucket, Algorithm>, Feedback> m_feedback;
+            std::mutex m_mutex;
+
+            double model_ms(Algorithm algorithm, const Shape& shape, int threads) const;
+            int best_threads(const Shape& shape) const;
+
+        public:
+            static constexpr double EXPLORE_RATIO = 1.5;
+            static constexpr double EWMA_WEIGHT = 0.3; // weight of the newest sample
+
+            // max_threads <= 0 uses every hardware thread
+            explicit AutoTuner(const CacheInfo& info = get_cache_info(), int max_threads = 0);
+
+            static AutoTuner& instance();
+
+            // B stored as Layout::Transposed rules out the recursive engine
+            AutoPlan plan(const Shape& shape, bool transposed_b = false);
+            void record(const Shape& shape, const AutoPlan& plan, double elapsed_ms);
+            // plan, run, record; `used` receives the plan that ran
+            Matrix multiply(const Matrix& A, const Matrix& B, AutoPlan* used = nullptr);
+    };
+
+        // A * B on the engine AutoTuner::instance() expects to be fastest
+        Matrix matmul_auto(const Matrix& A, const Matrix& B);
+}
+
+#endif // AUTO_HPP
@@ -0,0 +1,93 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <string>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    enum class Algorithm { Naive, Blocked, Recursive };
+
+    std::string algorithm_name(Algorithm algorithm);
+    Algorithm algorithm_from_name(const std::string& name);
+    bool is_parallel(Algorithm algorithm);
+
+    // C(m x n) = A(m x k) * B(k x n)
+    struct Shape {
+        int m, k, n;
+    };
+
+    std::string shape_name(const Shape& shape);
+    double flops(const Shape& shape);
+    bool supports(Algorithm algorithm, const Shape& shape);
+
+    struct BenchCase {
+        Algorithm algorithm;
+        Shape shape;
+        int threads;
+    };
+
+    struct BenchResult {
+        BenchCase bench_case;
+        std::vector<double> samples_ms;
+
+        double median_ms() const;
+    };
+
+    // Times `repeats` runs of one case on freshly filled operands
+    BenchResult run_benchmark(const BenchCase& bench_case, int block_size, int repeats);
+
+    struct SweepConfig {
+        std::vector<Shape> shapes;
+        std::vector<int> thread_counts;
+        std::vector<Algorithm> algorithms;
+        int block_size;
+        int repeats;
+    };
+
+    struct SweepResult {
+        std::vector<BenchResult> strong; // every shape at every thread count
+        std::vector<BenchResult> weak;   // shapes grown with the thread count, parallel algorithms only
+    };
+
+    // Each dimension scaled by threads^(1/3) so flops per thread stay constant
+    Shape weak_scaled(const Shape& base, int threads);
+
+    // Single-threaded algorithms are timed once per shape and reported at every thread count
+    SweepResult run_sweep(const SweepConfig& config);
+
+    // Lookup in a result list; nullptr if the case was not run
+    const BenchResult* find_result(const std::vector<BenchResult>& results, Algorithm algorithm,
+                                   const Shape& shape, int threads);
+
+    // Baseline file: one line per case, "<algorithm> <m> <k> <n> <threads> <sample ms>..."
+    struct Baseline {
+        int block_size;
+        std::vector<BenchResult> results;
+    };
+
+    void save_baseline(const std::string& path, const Baseline& baseline);
+    Baseline load_baseline(const std::string& path);
+
+    // Reruns every baseline case with the same block size and number of samples
+    std::vector<BenchResult> rerun_baseline(const Baseline& baseline);
+
+    // One-sided Mann-Whitney U test (normal approximation with tie correction):
+    // p-value for "current samples are slower than baseline samples"
+    double mann_whitney_p(const std::vector<double>& baseline, const std::vector<double>& current);
+
+    struct Comparison {
+        BenchCase bench_case;
+        double baseline_ms;
+        double current_ms;
+        double delta_pct;
+        double p_value;
+        bool regressed; // slower than threshold_pct and significant at alpha
+    };
+
+    std::vector<Comparison> compare_results(const std::vector<BenchResult>& baseline,
+                                            const std::vector<BenchResult>& current,
+                                            double threshold_pct, double alpha = 0.05);
+}
+
+#endif
@@ -14,10 +14,12 @@
 struct CacheInfo {
     long l1d_size;     // L1D size in bytes
     long line_size;    // Cache line size in bytes
+    long l2_size;      // L2 size in bytes (-1 if unknown)
+    long l3_size;      // L3 size in bytes (-1 if unknown)
 };
 
-CacheInfo get_cache_info() {
-    CacheInfo info = {-1, -1};
+inline CacheInfo get_cache_info() {
+    CacheInfo info = {-1, -1, -1, -1};
 #ifdef _WIN32
     SYSTEM_LOGICAL_PROCESSOR_INFORMATION* buffer = nullptr;
     DWORD size = 0;
@@ -34,7 +36,10 @@ CacheInfo get_cache_info() {
             buffer[i].Cache.Type == CacheData) {
             info.l1d_size = buffer[i].Cache.Size;
             info.line_size = buffer[i].Cache.LineSize;
-            break;
+        } else if (buffer[i].Relationship == RelationCache && buffer[i].Cache.Level == 2) {
+            info.l2_size = buffer[i].Cache.Size;
+        } else if (buffer[i].Relationship == RelationCache && buffer[i].Cache.Level == 3) {
+            info.l3_size = buffer[i].Cache.Size;
         }
     }
     free(buffer);
@@ -43,6 +48,12 @@ CacheInfo get_cache_info() {
     info.l1d_size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
     info.line_size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
 #endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    info.l2_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    info.l3_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
 #elif defined(__APPLE__)
     size_t len = sizeof(info.l1d_size);
     if (sysctlbyname("hw.l1dcachesize", &info.l1d_size, &len, nullptr, 0) == -1) {
@@ -52,6 +63,14 @@ CacheInfo get_cache_info() {
     if (sysctlbyname("hw.cachelinesize", &info.line_size, &len, nullptr, 0) == -1) {
         info.line_size = -1;
     }
+    len = sizeof(info.l2_size);
+    if (sysctlbyname("hw.l2cachesize", &info.l2_size, &len, nullptr, 0) == -1) {
+        info.l2_size = -1;
+    }
+    len = sizeof(info.l3_size);
+    if (sysctlbyname("hw.l3cachesize", &info.l3_size, &len, nullptr, 0) == -1) {
+        info.l3_size = -1;
+    }
 #endif
     return info;
 }
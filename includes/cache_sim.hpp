@@ -0,0 +1,67 @@
+#ifndef CACHE_SIM_HPP
+#define CACHE_SIM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "matrix.hpp"
+#include "cache_info.h"
+
+namespace matmul {
+    struct CacheLevelConfig {
+        std::string name;
+        size_t size_bytes;
+        size_t line_size;     // bytes
+        size_t associativity; // ways per set
+    };
+
+    struct CacheLevelStats {
+        std::string name;
+        uint64_t accesses;
+        uint64_t misses;
+    };
+
+    // Multi-level set-associative LRU cache model. Every access is looked up in
+    // L1 first; a miss is forwarded to the next level and the line is filled into
+    // every level it missed in.
+    class CacheSimulator {
+        private:
+            struct Level {
+                CacheLevelConfig config;
+                size_t num_sets;
+                std::vector<uint64_t> tags;   // num_sets * associativity, UINT64_MAX = invalid
+                std::vector<uint64_t> stamps; // last-use time for LRU
+                uint64_t accesses = 0;
+                uint64_t misses = 0;
+            };
+            std::vector<Level> m_levels;
+            uint64_t m_clock = 0;
+
+        public:
+            explicit CacheSimulator(const std::vector<CacheLevelConfig>& levels);
+
+            // Byte address in any address space; the simulate_* replays use synthetic ones
+            void access(uint64_t address);
+            void reset();
+            std::vector<CacheLevelStats> stats() const;
+    };
+
+    // L1D/L2/L3 taken from CacheInfo; levels the OS did not report are left out.
+    std::vector<CacheLevelConfig> cache_levels_from(const CacheInfo& info);
+
+    // Single-threaded replays of the matmul_* access patterns through the model. B may
+    // be Layout::Transposed for naive and blocked; simulate_recursive rejects it.
+    std::vector<CacheLevelStats> simulate_naive(const Matrix& A, const Matrix& B,
+                                                const std::vector<CacheLevelConfig>& levels);
+    // The tiled path of matmul_blocked, including its all-zero tile skipping. Shapes that
+    // matmul_blocked routes to matmul_skinny (single-row A, at most SKINNY_MAX_COLS
+    // columns) are still replayed as tiled, so their counts overstate the real traffic.
+    std::vector<CacheLevelStats> simulate_blocked(const Matrix& A, const Matrix& B, int block_size,
+                                                  const std::vector<CacheLevelConfig>& levels);
+    // cutoff <= 0 uses recursive_cutoff(), like matmul_recursive
+    std::vector<CacheLevelStats> simulate_recursive(const Matrix& A, const Matrix& B,
+                                                    const std::vector<CacheLevelConfig>& levels, int cutoff = 0);
+}
+
+#endif
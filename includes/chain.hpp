@@ -0,0 +1,49 @@
+#ifndef CHAIN_HPP
+#define CHAIN_HPP
+
+#include <string>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    // Reusable intermediate buffers. acquire() hands out the smallest released matrix
+    // whose allocation holds rows x cols (resized in place) before allocating a new one.
+    // At most max_free buffers are kept; releasing past that drops the oldest.
+    class MatrixPool {
+        private:
+            std::vector<Matrix> m_free; // oldest release first
+            size_t m_max_free;
+            size_t m_allocations = 0;
+
+        public:
+            explicit MatrixPool(size_t max_free = 8);
+
+            Matrix acquire(int rows, int cols);
+            void release(Matrix&& M);
+            size_t allocations() const;
+    };
+
+    struct ChainStep {
+        int first, split, last; // computes (M_first..M_split) * (M_split+1..M_last)
+        int m, k, n;
+        int num_threads;        // thread budget; normalize_blocking picks the team within it
+    };
+
+    struct ChainPlan {
+        std::vector<ChainStep> steps; // in execution order
+        double flops;
+        double cost;                  // flops + traffic_weight * elements touched
+        std::string parenthesization; // e.g. "((M0 M1) M2)"
+    };
+
+    // Optimal parenthesization for M_0 (dims[0] x dims[1]) ... M_{n-1} (dims[n-1] x dims[n]).
+    // Each product costs 2mkn flops plus traffic_weight per element of A, B and C touched.
+    ChainPlan plan_chain(const std::vector<int>& dims, int num_threads, double traffic_weight = 8.0);
+
+    // Product of all matrices in order, evaluated with plan_chain's parenthesization.
+    // Intermediates come from and return to `pool`; the result is allocated outside it.
+    Matrix matmul_chain(const std::vector<Matrix>& matrices, int block_size, int num_threads,
+                        MatrixPool* pool = nullptr, double traffic_weight = 8.0);
+}
+
+#endif
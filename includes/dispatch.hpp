@@ -0,0 +1,57 @@
+#ifndef DISPATCH_HPP
+#define DISPATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace matmul {
+    enum class Isa { Scalar, SSE41, AVX2, AVX512 };
+
+    std::string isa_name(Isa isa);
+
+    struct CpuFeatures {
+        bool sse41;
+        bool avx2;
+        bool avx512f;
+    };
+
+    // CPUID/XGETBV probe; everything is false on non-x86 builds
+    CpuFeatures detect_cpu_features();
+    Isa best_isa(const CpuFeatures& features);
+
+    // c[0..len) += a * b[0..len)
+    using AxpyKernel = void (*)(int* c, const int* b, int a, int len);
+    // C(rows x cols) += A(rows x depth) * B(depth x cols), row-major with strides in elements
+    using TileKernel = void (*)(const int* a, size_t lda, const int* b, size_t ldb,
+                                int* c, size_t ldc, int rows, int depth, int cols);
+    // C(rows x cols) += A(rows x depth) * B where bt holds B^T (cols x depth), so both
+    // operands are read with unit stride
+    using TileBtKernel = void (*)(const int* a, size_t lda, const int* bt, size_t ldbt,
+                                  int* c, size_t ldc, int rows, int depth, int cols);
+    // sum a[k] * b[k] for k < len
+    using DotKernel = int (*)(const int* a, const int* b, int len);
+    // Same with int64 accumulators and output; products are widened before the add
+    using WideTileKernel = void (*)(const int* a, size_t lda, const int* b, size_t ldb,
+                                    int64_t* c, size_t ldc, int rows, int depth, int cols);
+
+    struct KernelTable {
+        Isa isa;
+        AxpyKernel axpy;
+        TileKernel blocked_tile; // matmul_blocked inner tile
+        WideTileKernel blocked_tile_wide; // matmul_blocked_wide inner tile
+        DotKernel dot;
+        TileBtKernel blocked_tile_bt; // matmul_blocked with a Layout::Transposed B
+    };
+
+    // Kernel variants compiled for one ISA. Requesting an ISA the binary was not
+    // built with (non-x86 or non-GCC/Clang compilers) falls back to scalar.
+    KernelTable kernels_for(Isa isa);
+
+    // Resolved once on first use: the best ISA the CPU supports, or the one named by
+    // the MATMUL_ISA environment variable (scalar, sse4.1, avx2, avx512), capped to
+    // what the CPU supports.
+    const KernelTable& kernels();
+}
+
+#endif
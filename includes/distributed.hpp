@@ -0,0 +1,39 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <cstdint>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    struct DistributedStats {
+        int ranks = 0;
+        double wall_ms = 0;             // fork to assembled C, seen by the caller
+        std::vector<double> compute_ms; // per rank: local matmul_blocked calls
+        std::vector<double> comm_ms;    // per rank: exchanging, replicating and reducing blocks
+        std::vector<uint64_t> bytes_sent;     // per rank, between ranks (not the final gather)
+        std::vector<uint64_t> bytes_received;
+    };
+
+    // SUMMA over ranks = g*g worker processes on a g x g grid, one block of A, B and
+    // C each per rank. At step s, rank (i, s) sends its A block along grid row i and
+    // rank (s, j) sends its B block down grid column j; every rank then multiplies
+    // the two received panels with matmul_blocked and adds the result into its C block.
+    // Ranks are forked from the caller and connected by Unix socket pairs; each rank
+    // sends from its own thread while the main thread receives, so exchanges cannot
+    // deadlock. Blocks of A and B start in each rank's memory; C blocks are gathered
+    // back to the caller. POSIX only: throws std::runtime_error elsewhere.
+        Matrix matmul_summa(const Matrix& A, const Matrix& B, int ranks, int block_size,
+                            int threads_per_rank, DistributedStats* stats = nullptr);
+
+        // 2.5D variant on grid x grid x replication ranks (replication must divide grid).
+        // Layer 0 owns the blocks and copies them to the other layers; each layer runs
+        // grid / replication of the SUMMA steps and the partial C blocks are summed back
+        // onto layer 0. Each rank then moves about sqrt(replication) times fewer words
+        // than SUMMA on the same number of ranks, at replication times the memory.
+        // replication = 1 is matmul_summa.
+        Matrix matmul_25d(const Matrix& A, const Matrix& B, int grid, int replication, int block_size,
+                          int threads_per_rank, DistributedStats* stats = nullptr);
+}
+
+#endif // DISTRIBUTED_HPP
@@ -0,0 +1,50 @@
+#ifndef EPILOGUE_HPP
+#define EPILOGUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    // Elementwise operations applied to each C tile in the blocked engine right after
+    // its last k-block, before the tile leaves cache. Operations run in the order added.
+    class Epilogue {
+        private:
+            enum class Kind { RowBias, ColBias, Scale, Clamp, Relu };
+            struct Op {
+                Kind kind;
+                std::vector<int> bias;
+                int a, b; // Scale: multiplier, shift; Clamp: lo, hi
+            };
+            std::vector<Op> m_ops;
+
+        public:
+            Epilogue& bias_rows(std::vector<int> bias); // C(i,j) += bias[i]
+            Epilogue& bias_cols(std::vector<int> bias); // C(i,j) += bias[j]
+            // C = round(C * multiplier / 2^shift), computed in 64 bits
+            Epilogue& scale(int multiplier, int shift = 0);
+            Epilogue& clamp(int lo, int hi);
+            Epilogue& relu();
+
+            bool empty() const;
+            // Throws if a bias vector does not match an m x n result
+            void validate(int rows, int cols) const;
+            // tile points at C(row0, col0); ld is the row stride in elements
+            void apply(int* tile, size_t ld, int row0, int col0, int rows, int cols) const;
+    };
+
+    // int32 -> int8: clamp(round(c * multiplier / 2^shift) + zero_point, -128, 127)
+    struct Requantize {
+        int multiplier;
+        int shift;
+        int zero_point;
+
+        // Throws unless shift is in [0, 62], like Epilogue::scale
+        void validate() const;
+        // Per element inside parallel loops; callers validate() once beforehand
+        int8_t operator()(int value) const;
+    };
+}
+
+#endif
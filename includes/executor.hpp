@@ -0,0 +1,55 @@
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "matrix.hpp"
+#include "scheduler.hpp"
+
+namespace matmul {
+    // Persistent workers that run submitted products with CoreLease::multiply. Each job
+    // asks a ComputeScheduler for a core budget sized to its flops, so small jobs run
+    // side by side on disjoint cores, and executors share the machine with every
+    // other tenant of the same scheduler instead of oversubscribing it. A job granted
+    // less than its budget grows into cores that finished jobs release.
+    class Executor {
+        private:
+            struct Job {
+                Matrix A, B;
+                int cores;
+                Priority priority;
+                LatencyClass latency;
+                std::promise<Matrix> result;
+            };
+
+            ComputeScheduler& m_scheduler;
+            int m_block_size;
+            bool m_stopping = false;
+            std::deque<Job> m_queue;
+            std::mutex m_mutex;
+            std::condition_variable m_ready;
+            std::vector<std::thread> m_workers;
+
+            void worker_loop();
+
+        public:
+            explicit Executor(int block_size = 64, ComputeScheduler& scheduler = ComputeScheduler::instance());
+            ~Executor(); // finishes every queued job
+
+            Executor(const Executor&) = delete;
+            Executor& operator=(const Executor&) = delete;
+
+            // Operands are taken by value; move them in to avoid the copy. Queued jobs
+            // start highest priority first, then in submission order.
+            std::future<Matrix> submit(Matrix A, Matrix B, Priority priority = Priority::Normal,
+                                       LatencyClass latency = LatencyClass::Batch);
+
+            int total_cores() const;
+    };
+}
+
+#endif // EXECUTOR_HPP
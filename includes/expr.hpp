@@ -0,0 +1,214 @@
+#ifndef EXPR_HPP
+#define EXPR_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    struct ProductTerm {
+        int scale;
+        const Matrix* A;
+        const Matrix* B;
+    };
+
+    struct MatrixTerm {
+        int scale;
+        const Matrix* M;
+    };
+
+    // C = sum(scale * A * B) + sum(scale * M) in one pass over the tiles of C.
+    // Additive terms are applied to each tile right after its products, while
+    // it is still in cache, so no full-size temporaries are created.
+    void evaluate_fused(const std::vector<ProductTerm>& products, const std::vector<MatrixTerm>& addends,
+                        Matrix& C, int block_size, int num_threads);
+
+    // Lazy expressions: A * B, A + B, A - B, alpha * E and -E build a tree that is
+    // flattened into product and matrix terms and evaluated by evaluate_fused.
+    // Leaves hold references, so operands must outlive the expression.
+    namespace expr {
+        // block_size_for(get_cache_info()), looked up once per process
+        int default_block_size();
+
+        // Flattened form; products of non-leaf expressions are materialized into `temporaries`
+        struct Terms {
+            std::vector<ProductTerm> products;
+            std::vector<MatrixTerm> addends;
+            std::vector<std::unique_ptr<Matrix>> temporaries;
+            int rows = 0, cols = 0;
+        };
+
+        template <typename E>
+        struct Expr {
+            const E& self() const { return static_cast<const E&>(*this); }
+
+            Matrix eval(int block_size, int num_threads) const {
+                Terms terms;
+                self().collect(terms, 1, block_size, num_threads);
+                Matrix C(terms.rows, terms.cols);
+                evaluate_fused(terms.products, terms.addends, C, block_size, num_threads);
+                return C;
+            }
+
+            // Matrix D = A * B + C; uses the cache-derived block size and all hardware threads
+            operator Matrix() const {
+                return eval(default_block_size(), static_cast<int>(std::thread::hardware_concurrency()));
+            }
+        };
+
+        struct Leaf : Expr<Leaf> {
+            const Matrix& m;
+            explicit Leaf(const Matrix& matrix) : m(matrix) {}
+
+            void collect(Terms& terms, int scale, int, int) const {
+                if (m.layout() != Layout::RowMajor) {
+                    throw std::invalid_argument("Matrix expressions do not support transposed operands");
+                }
+                terms.addends.push_back({scale, &m});
+                terms.rows = m.get_rows();
+                terms.cols = m.get_cols();
+            }
+        };
+
+        template <typename E>
+        const Matrix& materialize(const Expr<E>& e, Terms& terms, int block_size, int num_threads) {
+            terms.temporaries.push_back(std::make_unique<Matrix>(e.self().eval(block_size, num_threads)));
+            return *terms.temporaries.back();
+        }
+
+        template <typename E>
+        struct Scaled;
+
+        // A product operand resolved to a matrix and the scalar factor pulled out of it
+        struct Operand {
+            const Matrix* m;
+            int factor;
+        };
+
+        inline Operand operand_of(const Leaf& leaf, Terms&, int, int) {
+            return {&leaf.m, 1};
+        }
+
+        template <typename E>
+        Operand operand_of(const Scaled<E>& scaled, Terms& terms, int block_size, int num_threads);
+
+        template <typename E>
+        Operand operand_of(const Expr<E>& e, Terms& terms, int block_size, int num_threads) {
+            return {&materialize(e, terms, block_size, num_threads), 1};
+        }
+
+        template <typename L, typename R>
+        struct Product : Expr<Product<L, R>> {
+            L lhs;
+            R rhs;
+            Product(const L& l, const R& r) : lhs(l), rhs(r) {}
+
+            // alpha * A * B folds alpha into the term; only products of sums or
+            // nested products need a temporary
+            void collect(Terms& terms, int scale, int block_size, int num_threads) const {
+                const Operand a = operand_of(lhs, terms, block_size, num_threads);
+                const Operand b = operand_of(rhs, terms, block_size, num_threads);
+                if (b.m->layout() != Layout::RowMajor) {
+                    throw std::invalid_argument("Matrix expressions do not support transposed operands");
+                }
+                if (a.m->get_cols() != b.m->get_rows()) {
+                    throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+                }
+                terms.products.push_back({scale * a.factor * b.factor, a.m, b.m});
+                terms.rows = a.m->get_rows();
+                terms.cols = b.m->get_cols();
+            }
+        };
+
+        template <typename E>
+        struct Scaled : Expr<Scaled<E>> {
+            E inner;
+            int factor;
+            Scaled(const E& e, int f) : inner(e), factor(f) {}
+
+            void collect(Terms& terms, int scale, int block_size, int num_threads) const {
+                inner.collect(terms, scale * factor, block_size, num_threads);
+            }
+        };
+
+        template <typename E>
+        Operand operand_of(const Scaled<E>& scaled, Terms& terms, int block_size, int num_threads) {
+            Operand inner = operand_of(scaled.inner, terms, block_size, num_threads);
+            inner.factor *= scaled.factor;
+            return inner;
+        }
+
+        template <typename L, typename R>
+        struct Sum : Expr<Sum<L, R>> {
+            L lhs;
+            R rhs;
+            int sign; // +1 or -1 applied to rhs
+            Sum(const L& l, const R& r, int s) : lhs(l), rhs(r), sign(s) {}
+
+            void collect(Terms& terms, int scale, int block_size, int num_threads) const {
+                lhs.collect(terms, scale, block_size, num_threads);
+                const int rows = terms.rows, cols = terms.cols;
+                rhs.collect(terms, scale * sign, block_size, num_threads);
+                if (rows != terms.rows || cols != terms.cols) {
+                    throw std::invalid_argument("Matrix dimensions do not match for addition");
+                }
+            }
+        };
+
+        // Matrix operands become leaves; expressions pass through unchanged
+        inline Leaf wrap(const Matrix& m) { return Leaf(m); }
+        template <typename E>
+        const E& wrap(const Expr<E>& e) { return e.self(); }
+
+        template <typename T>
+        using wrapped_t = std::decay_t<decltype(wrap(std::declval<const T&>()))>;
+
+        template <typename T>
+        constexpr bool is_operand_v = std::is_same_v<T, Matrix> || std::is_base_of_v<Expr<T>, T>;
+    }
+
+    template <typename L, typename R,
+              typename = std::enable_if_t<expr::is_operand_v<L> && expr::is_operand_v<R>>>
+    expr::Product<expr::wrapped_t<L>, expr::wrapped_t<R>> operator*(const L& l, const R& r) {
+        return {expr::wrap(l), expr::wrap(r)};
+    }
+
+    template <typename L, typename R,
+              typename = std::enable_if_t<expr::is_operand_v<L> && expr::is_operand_v<R>>>
+    expr::Sum<expr::wrapped_t<L>, expr::wrapped_t<R>> operator+(const L& l, const R& r) {
+        return {expr::wrap(l), expr::wrap(r), 1};
+    }
+
+    template <typename L, typename R,
+              typename = std::enable_if_t<expr::is_operand_v<L> && expr::is_operand_v<R>>>
+    expr::Sum<expr::wrapped_t<L>, expr::wrapped_t<R>> operator-(const L& l, const R& r) {
+        return {expr::wrap(l), expr::wrap(r), -1};
+    }
+
+    template <typename E, typename = std::enable_if_t<expr::is_operand_v<E>>>
+    expr::Scaled<expr::wrapped_t<E>> operator*(int alpha, const E& e) {
+        return {expr::wrap(e), alpha};
+    }
+
+    template <typename E, typename = std::enable_if_t<expr::is_operand_v<E>>>
+    expr::Scaled<expr::wrapped_t<E>> operator*(const E& e, int alpha) {
+        return {expr::wrap(e), alpha};
+    }
+
+    template <typename E, typename = std::enable_if_t<expr::is_operand_v<E>>>
+    expr::Scaled<expr::wrapped_t<E>> operator-(const E& e) {
+        return {expr::wrap(e), -1};
+    }
+
+    // Evaluates an expression with explicit tiling; a plain Matrix needs no evaluation
+    template <typename E>
+    Matrix evaluate(const expr::Expr<E>& e, int block_size, int num_threads) {
+        return e.self().eval(block_size, num_threads);
+    }
+}
+
+#endif
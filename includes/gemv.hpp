@@ -0,0 +1,25 @@
+#ifndef GEMV_HPP
+#define GEMV_HPP
+
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    // Matrix-vector products are memory-bound: A is streamed once, front to back,
+    // through the dispatched SIMD kernels with no tiling or C zeroing.
+
+    // Widest B (in columns) that matmul_blocked hands to matmul_skinny
+    constexpr int SKINNY_MAX_COLS = 16;
+
+        // y = A * x; rows are split across threads
+        std::vector<int> gemv(const Matrix& A, const std::vector<int>& x, int num_threads = 1);
+
+        // y = x^T * A; rows are split across threads, each summing into a partial y
+        std::vector<int> gevm(const std::vector<int>& x, const Matrix& A, int num_threads = 1);
+
+        // C = A * B for a B with few columns (row-major or Layout::Transposed). Every
+        // row of A is read once and dotted against all columns of B while it is in L1.
+        Matrix matmul_skinny(const Matrix& A, const Matrix& B, int num_threads = 1);
+}
+
+#endif // GEMV_HPP
@@ -1,34 +1,162 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 
 namespace matmul {
-    class Matrix {
+    constexpr size_t CACHE_LINE_SIZE = 64;
+    constexpr size_t ALIGNMENT = CACHE_LINE_SIZE / sizeof(int); // 16 ints for 64 bytes
+
+    // How a matrix is read as the B operand of matmul_blocked/matmul_naive. Transposed
+    // marks storage holding B^T for a logical B; at(), get_rows() and get_cols()
+    // always address the storage.
+    enum class Layout { RowMajor, Transposed };
+
+    template <typename T>
+    class BasicMatrix {
         private:
             int m_rows, m_cols;
-            std::vector<int> m_data;
+            std::vector<T> m_data;
             size_t m_row_stride; // For cache-aligned rows   
+            bool m_aligned;
+            Layout m_layout = Layout::RowMajor;
 
         public:
-            Matrix(int r, int c, bool align = true);
+            BasicMatrix(int r, int c, bool align = true);
 
             void fill_matrix();
+            // New dimensions, keeping the allocation when it is large enough; contents are unspecified
+            void resize(int r, int c);
+            size_t capacity() const; // in elements
 
             int get_rows() const;
             int get_cols() const;
-            std::vector<int> get_data() const;
-            int& at(int i, int j);
-            const int& at(int i, int j) const;
+            std::vector<T> get_data() const;
+            T& at(int i, int j);
+            const T& at(int i, int j) const;
 
-            int* data();
+            T* data();
+            const T* data() const;
             size_t row_stride() const;
+            // Row stride of an aligned matrix with `cols` columns
+            static size_t padded_stride(int cols);
+
+            Layout layout() const;
+            void set_layout(Layout layout);
+        };
+
+        // Instantiated in matrix.cpp
+        extern template class BasicMatrix<int>;
+        extern template class BasicMatrix<std::int64_t>;
+        extern template class BasicMatrix<std::int8_t>;
+
+        using Matrix = BasicMatrix<int>;
+        using Matrix64 = BasicMatrix<std::int64_t>; // widened results
+        using Matrix8 = BasicMatrix<std::int8_t>;   // requantized results
+
+        class Epilogue;
+        struct Requantize;
+
+        // One flag per block_size x block_size tile: set if the tile holds any non-zero.
+        // Built in a single parallel pass that stops scanning a tile at its first non-zero.
+        class TileOccupancy {
+            private:
+                int m_tile_rows, m_tile_cols;
+                std::vector<unsigned char> m_bits;
+
+            public:
+                TileOccupancy(const Matrix& M, int block_size, int num_threads = 1);
+
+                bool occupied(int tile_row, int tile_col) const;
+                int tile_rows() const;
+                int tile_cols() const;
+                size_t occupied_count() const;
         };
 
+        struct KernelTable;
+
+        // matmul_blocked split for callers that run row ranges of C on their own threads.
+        // The block size is normalized, both occupancy maps built and the tile kernels
+        // resolved once; rows() then reads A and B in place. B may be Layout::Transposed.
+        // A and B must outlive the object.
+        class BlockedProduct {
+            private:
+                const Matrix& m_A;
+                const Matrix& m_B;
+                int m_block_size;
+                TileOccupancy m_occupied_a;
+                TileOccupancy m_occupied_b;
+                const KernelTable& m_kernels;
+
+                static int normalized_block_size(const Matrix& A, const Matrix& B, int block_size);
+
+            public:
+                // num_threads only parallelizes the occupancy scans
+                BlockedProduct(const Matrix& A, const Matrix& B, int block_size, int num_threads = 1);
+
+                int block_size() const;
+                // Rows [row_begin, row_end) of C = A * B on the calling thread; both ends on
+                // block boundaries, except row_end may be C's row count
+                void rows(Matrix& C, int row_begin, int row_end) const;
+        };
+
+        // B may be Layout::Transposed in matmul_naive and the matmul_blocked overloads
         Matrix matmul_naive(const Matrix& A, const Matrix& B);
+        // Rounds the block size to whole cache lines and picks the thread count (at most
+        // num_threads) for an (m x depth) * (depth x n) product; shared by the tiled engines.
+        // occupied_fraction is passed through to parallel_threads.
+        void normalize_blocking(int m, int n, int depth, int& block_size, int& num_threads,
+                                double occupied_fraction = 1.0);
+
+        // Measured once per process by init(), or on the first call that asks for more
+        // than one thread if init() was never called
+        struct ParallelCost {
+            double fork_join_ms;      // starting and joining an OpenMP team, per thread
+            double tile_flops_per_ms; // dispatched tile kernel on one core
+        };
+        const ParallelCost& parallel_cost();
+        // Startup work: resolves the kernel dispatch and calibrates parallel_cost() with a
+        // full-width team. Call it once from the main thread before any lease or worker
+        // runs a multiply, so the calibration neither lands inside one nor ignores it.
+        void init();
+        // Fewest threads (1..max_threads) minimizing fork-join cost plus the busiest
+        // thread's share of C tiles for a blocked (m x depth) * (depth x n) product.
+        // occupied_fraction scales the tile work for tile pairs skipped as all zero.
+        int parallel_threads(int m, int n, int depth, int block_size, int max_threads,
+                             double occupied_fraction = 1.0);
+
+        // Skips (i,k) x (k,j) tile pairs where either tile is all zero
         Matrix matmul_blocked(const Matrix& A, const Matrix& B, int block_size, int num_threads);
-        Matrix matmul_recursive(const Matrix& A, const Matrix& B);
+        // Epilogue applied to every C tile while it is still in cache
+        Matrix matmul_blocked(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                              const Epilogue& epilogue);
+        // Accumulates each tile in a per-thread int32 buffer, runs the epilogue and stores int8
+        Matrix8 matmul_blocked_requantized(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                                           const Epilogue& epilogue, const Requantize& requantize);
+        // Writes into a preallocated C of size A.rows x B.cols
+        void matmul_blocked_into(const Matrix& A, const Matrix& B, Matrix& C, int block_size, int num_threads);
+        // Cache-oblivious: halves the largest of m, k and n until all three fit the cutoff,
+        // then runs the dispatched SIMD tile kernel, which accumulates into C. Works for any
+        // shape. cutoff <= 0 uses recursive_cutoff().
+        Matrix matmul_recursive(const Matrix& A, const Matrix& B, int cutoff = 0);
+        // Leaf size autotuned once per process (16 to 128) on a 256^3 product
+        int recursive_cutoff();
+
+        enum class Accumulation {
+            Auto,  // 32-bit when int32_accumulation_safe() proves it, 64-bit otherwise
+            Int32, // wraps on overflow, like matmul_blocked
+            Int64
+        };
+
+        // True if no partial sum of A*B can leave the int32 range:
+        // max_i sum_k |A(i,k)| * max_j |B(k,j)| <= INT32_MAX. Costs O(mk + kn).
+        bool int32_accumulation_safe(const Matrix& A, const Matrix& B, int num_threads = 1);
+
+        // Blocked multiply with int64 output; Int64 accumulates with widening SIMD multiplies
+        Matrix64 matmul_blocked_wide(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                                     Accumulation mode = Accumulation::Auto);
 }
 
 #endif
\ No newline at end of file
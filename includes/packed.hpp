@@ -0,0 +1,77 @@
+#ifndef PACKED_HPP
+#define PACKED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    // B repacked once for matmul_blocked: every block_size-wide column panel is stored
+    // contiguously, so each (k, j) tile is a dense block_size x block_size array with a
+    // short, fixed stride. All-zero tiles are recorded at pack time and skipped.
+    class PackedMatrix {
+        private:
+            int m_rows;
+            int m_cols;
+            int m_block_size;
+            std::vector<int> m_panels;
+            std::vector<char> m_occupied; // per (k-block, j-block) tile
+
+        public:
+            // B may be Layout::Transposed; the packed form always holds the logical B
+            PackedMatrix(const Matrix& B, int block_size);
+
+            int get_rows() const;
+            int get_cols() const;
+            int block_size() const;
+            size_t bytes() const;
+            // Tile (k, j) in element coordinates, with row stride block_size()
+            const int* tile(int k, int j) const;
+            bool occupied(int k, int j) const;
+    };
+
+        // C = A * B against a prepacked B; tiling follows B's block size
+        Matrix matmul_blocked(const Matrix& A, const PackedMatrix& B, int num_threads);
+
+    // Packed operands keyed by the source matrix's address, a caller-maintained version
+    // and the block size, evicted least recently used first once the packed bytes exceed
+    // the budget. Bumping the version when B changes drops the stale pack at that block
+    // size on next use. Packing runs outside the lock, so hits never wait for a miss.
+    // Returned handles stay valid after eviction. Safe to share between threads.
+    class PackCache {
+        private:
+            using Key = std::tuple<const Matrix*, uint64_t, int>;
+            struct Entry {
+                Key key;
+                std::shared_ptr<const PackedMatrix> packed;
+            };
+
+            size_t m_budget_bytes;
+            size_t m_used_bytes = 0;
+            size_t m_hits = 0;
+            size_t m_misses = 0;
+            std::list<Entry> m_lru; // most recently used first
+            std::map<Key, std::list<Entry>::iterator> m_index;
+            std::mutex m_mutex;
+
+            void evict(std::list<Entry>::iterator it);
+
+        public:
+            explicit PackCache(size_t budget_bytes);
+
+            std::shared_ptr<const PackedMatrix> get(const Matrix& B, uint64_t version, int block_size);
+            void clear();
+
+            size_t used_bytes();
+            size_t hits();
+            size_t misses();
+    };
+}
+
+#endif // PACKED_HPP
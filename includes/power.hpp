@@ -0,0 +1,19 @@
+#ifndef POWER_HPP
+#define POWER_HPP
+
+#include <cstdint>
+#include "matrix.hpp"
+
+namespace matmul {
+    // A^k by binary exponentiation: O(log k) products through matmul_blocked_into,
+    // alternating between two preallocated buffers. A^0 is the identity.
+    // Entries wrap modulo 2^32 on overflow, like every int engine.
+        Matrix matmul_power(const Matrix& A, uint64_t k, int block_size, int num_threads);
+
+        // A^k with every entry reduced modulo `modulus` (1 <= modulus < 2^31). Products
+        // accumulate in int64 and are reduced before they can overflow, so the result
+        // is exact for any k and size.
+        Matrix matmul_power_mod(const Matrix& A, uint64_t k, int modulus, int block_size, int num_threads);
+}
+
+#endif // POWER_HPP
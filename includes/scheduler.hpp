@@ -0,0 +1,120 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    enum class Priority { Low, Normal, High };
+    // Interactive jobs start as soon as one core is free, with whatever is free;
+    // Batch jobs wait for their full budget
+    enum class LatencyClass { Batch, Interactive };
+
+    // CPUs grouped by shared L3 and NUMA node, restricted to the process affinity mask.
+    // Read from /sys on Linux; elsewhere one domain of hardware_concurrency() CPUs.
+    std::vector<std::vector<int>> detect_core_domains();
+
+    class ComputeScheduler;
+
+    // Exclusive use of a set of CPUs, returned to the scheduler on destruction
+    class CoreLease {
+        private:
+            ComputeScheduler* m_scheduler = nullptr;
+            std::vector<int> m_cpus;
+
+            friend class ComputeScheduler;
+            CoreLease(ComputeScheduler* scheduler, std::vector<int> cpus);
+
+        public:
+            CoreLease() = default;
+            CoreLease(CoreLease&& other) noexcept;
+            CoreLease& operator=(CoreLease&& other) noexcept;
+            CoreLease(const CoreLease&) = delete;
+            CoreLease& operator=(const CoreLease&) = delete;
+            ~CoreLease();
+
+            int size() const;
+            const std::vector<int>& cpus() const;
+            // Takes up to `extra` more free cores, but only while nobody is waiting
+            int grow(int extra);
+            void release();
+            // C = A * B on the scheduler's worker thread for each leased CPU (pinned, best
+            // effort where thread affinity is unavailable). B's occupancy and the kernels are
+            // set up once; workers take block_size-row panels of C from a shared counter and
+            // read A in place. Between panels the lease grows toward max_cores with cores
+            // freed by finished jobs, and the workers of the CPUs it gains join in.
+            Matrix multiply(const Matrix& A, const Matrix& B, int block_size, int max_cores = 0);
+    };
+
+    // Process-wide core budget shared by every tenant. Waiters are served by priority,
+    // then arrival. Jobs further back may start on cores the head cannot use yet, up to
+    // a bounded number of times. Cores are handed out from a single L3/NUMA domain
+    // whenever the request fits in one. Each CPU has one pinned worker thread, started
+    // on first use and kept for the scheduler's lifetime, that runs its lease's work.
+    class ComputeScheduler {
+        private:
+            class CpuWorker;
+
+            struct Waiter {
+                int wanted;
+                Priority priority;
+                LatencyClass latency;
+                uint64_t seq;
+                int skipped = 0;
+                bool granted = false;
+                std::vector<int> cpus;
+            };
+
+            std::vector<std::vector<int>> m_domains;
+            std::vector<std::vector<int>> m_free;  // free CPUs per domain
+            int m_total_cores = 0;
+            int m_free_cores = 0;
+            uint64_t m_next_seq = 0;
+            std::list<Waiter*> m_waiters;          // priority, then arrival
+            std::mutex m_mutex;
+            std::condition_variable m_changed;
+            std::map<int, std::unique_ptr<CpuWorker>> m_workers;
+            std::mutex m_workers_mutex;
+
+            std::vector<int> take(int count);
+            void give_back(const std::vector<int>& cpus);
+            void dispatch();
+
+            friend class CoreLease;
+            void release(std::vector<int>& cpus);
+            int grow(std::vector<int>& cpus, int extra);
+            // Queues `task` on the CPU's worker; only the lease holding the CPU posts to it
+            void run_on(int cpu, std::function<void()> task);
+
+        public:
+            explicit ComputeScheduler(std::vector<std::vector<int>> domains = detect_core_domains());
+            ComputeScheduler(const ComputeScheduler&) = delete;
+            ComputeScheduler& operator=(const ComputeScheduler&) = delete;
+            ~ComputeScheduler();
+
+            static ComputeScheduler& instance();
+
+            // Blocks until cores are granted. Batch jobs get min(wanted, total_cores()),
+            // interactive jobs get between 1 and that many.
+            CoreLease acquire(int wanted, Priority priority = Priority::Normal,
+                              LatencyClass latency = LatencyClass::Batch);
+
+            int total_cores() const;
+            int free_cores();
+    };
+
+        // CoreLease::multiply on a lease from the process-wide scheduler; an interactive
+        // lease granted fewer than num_threads cores grows as they are freed
+        Matrix matmul_scheduled(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                                Priority priority = Priority::Normal,
+                                LatencyClass latency = LatencyClass::Batch);
+}
+
+#endif // SCHEDULER_HPP
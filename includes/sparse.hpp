@@ -0,0 +1,66 @@
+#ifndef SPARSE_HPP
+#define SPARSE_HPP
+
+#include <cstddef>
+#include <vector>
+#include "matrix.hpp"
+
+namespace matmul {
+    // Compressed sparse row storage
+    class CsrMatrix {
+        private:
+            int m_rows, m_cols;
+            std::vector<int> m_row_ptr; // m_rows + 1 offsets into m_col_idx/m_values
+            std::vector<int> m_col_idx;
+            std::vector<int> m_values;
+
+        public:
+            CsrMatrix(int rows, int cols, std::vector<int> row_ptr, std::vector<int> col_idx, std::vector<int> values);
+
+            static CsrMatrix from_dense(const Matrix& M);
+            Matrix to_dense() const;
+
+            int get_rows() const;
+            int get_cols() const;
+            size_t nnz() const;
+            const std::vector<int>& row_ptr() const;
+            const std::vector<int>& col_idx() const;
+            const std::vector<int>& values() const;
+    };
+
+    // Compressed sparse column storage
+    class CscMatrix {
+        private:
+            int m_rows, m_cols;
+            std::vector<int> m_col_ptr; // m_cols + 1 offsets into m_row_idx/m_values
+            std::vector<int> m_row_idx;
+            std::vector<int> m_values;
+
+        public:
+            CscMatrix(int rows, int cols, std::vector<int> col_ptr, std::vector<int> row_idx, std::vector<int> values);
+
+            static CscMatrix from_dense(const Matrix& M);
+            Matrix to_dense() const;
+
+            int get_rows() const;
+            int get_cols() const;
+            size_t nnz() const;
+            const std::vector<int>& col_ptr() const;
+            const std::vector<int>& row_idx() const;
+            const std::vector<int>& values() const;
+    };
+
+    // Dense matrix where each entry is non-zero with probability `density`
+    Matrix random_sparse(int rows, int cols, double density);
+
+    // C = A * B for sparse A and dense B. Rows of A are cut into panels holding
+    // roughly equal numbers of non-zeros and scheduled across threads; inside a
+    // panel the columns of B and C are walked in blocks of block_cols.
+    Matrix matmul_spmm(const CsrMatrix& A, const Matrix& B, int block_cols, int num_threads);
+
+    // Column-stored A: threads own disjoint column blocks of C, so scattered
+    // updates never race.
+    Matrix matmul_spmm(const CscMatrix& A, const Matrix& B, int block_cols, int num_threads);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef STREAMING_HPP
+#define STREAMING_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "matrix.hpp"
+#include "packed.hpp"
+
+namespace matmul {
+    // C = A * B for an A that arrives as row panels. B is packed once. A background
+    // worker multiplies each pushed panel while the caller receives or reads the next
+    // one, and hands the matching C rows to the callback in push order, on the worker
+    // thread. push() blocks while max_queued panels are still waiting.
+    class StreamingMatmul {
+        public:
+            // first_row: index of the panel's first row within the whole A
+            using PanelCallback = std::function<void(int first_row, Matrix panel)>;
+
+        private:
+            struct Panel {
+                int first_row;
+                Matrix rows;
+            };
+
+            PackedMatrix m_packed;
+            PanelCallback m_on_panel;
+            int m_num_threads;
+            size_t m_max_queued;
+            int m_rows_pushed = 0;
+            bool m_busy = false;
+            bool m_closed = false;
+            std::exception_ptr m_error;
+            std::deque<Panel> m_queue;
+            mutable std::mutex m_mutex;
+            std::condition_variable m_changed;
+            std::thread m_worker;
+
+            void worker_loop();
+
+        public:
+            StreamingMatmul(const Matrix& B, PanelCallback on_panel, int block_size, int num_threads,
+                            size_t max_queued = 2);
+            ~StreamingMatmul(); // waits for queued panels; errors are dropped, call finish() to see them
+
+            StreamingMatmul(const StreamingMatmul&) = delete;
+            StreamingMatmul& operator=(const StreamingMatmul&) = delete;
+
+            // rows: a panel of A (any row count, B.rows() columns)
+            void push(Matrix rows);
+            // Waits until every pushed panel has been delivered; rethrows the first
+            // error from the multiply or the callback
+            void finish();
+
+            int rows_pushed() const;
+    };
+}
+
+#endif // STREAMING_HPP
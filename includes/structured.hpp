@@ -0,0 +1,24 @@
+#ifndef STRUCTURED_HPP
+#define STRUCTURED_HPP
+
+#include "matrix.hpp"
+
+namespace matmul {
+    // Known zero pattern of a left operand: A(i, k) may be non-zero only for
+    // i - lower <= k <= i + upper. Entries outside the band are never read.
+    struct Band {
+        int lower;
+        int upper;
+
+        static Band upper_triangular();   // k >= i
+        static Band lower_triangular();   // k <= i
+        static Band banded(int lower, int upper);
+    };
+
+        // C = A * B touching only the k-range inside the band for each block row. Block
+        // rows are split across threads by their non-zero flop count, not tile count.
+        Matrix matmul_structured(const Matrix& A, const Band& band, const Matrix& B,
+                                 int block_size, int num_threads);
+}
+
+#endif // STRUCTURED_HPP
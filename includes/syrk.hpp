@@ -0,0 +1,18 @@
+#ifndef SYRK_HPP
+#define SYRK_HPP
+
+#include "matrix.hpp"
+
+namespace matmul {
+    enum class Gram { AAt, AtA };       // C = A * A^T or C = A^T * A
+    enum class Triangle { Upper, Lower };
+
+    // Symmetric rank-k update: computes only the tiles on and to one side of C's
+    // diagonal (about half the flops and stores of matmul_blocked). The triangle tiles
+    // are flattened into one list that threads share, so work stays balanced. With
+    // mirror the other triangle is filled by copying; otherwise its entries are zero.
+        Matrix syrk(const Matrix& A, Gram gram, Triangle triangle, int block_size, int num_threads,
+                    bool mirror = true);
+}
+
+#endif // SYRK_HPP
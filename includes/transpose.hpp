@@ -0,0 +1,20 @@
+#ifndef TRANSPOSE_HPP
+#define TRANSPOSE_HPP
+
+#include "matrix.hpp"
+
+namespace matmul {
+    // Cache-oblivious transposes: the larger dimension is halved until a block fits
+    // comfortably in L1, so no block size has to be tuned per machine. The top levels
+    // of the recursion run as OpenMP tasks.
+        Matrix transpose(const Matrix& M, int num_threads = 1);
+
+        // Square matrices only: swaps mirrored off-diagonal blocks in place
+        void transpose_inplace(Matrix& M, int num_threads = 1);
+
+        // B^T stored with Layout::Transposed, so matmul_blocked(A, transposed_operand(B))
+        // computes A*B while streaming both operands along their rows
+        Matrix transposed_operand(const Matrix& B, int num_threads = 1);
+}
+
+#endif // TRANSPOSE_HPP
@@ -0,0 +1,38 @@
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "matrix.hpp"
+
+namespace matmul {
+    // Freivalds' check: C == A*B is tested as A*(B*r) == C*r for random 0/1
+    // vectors r in O(n^2) per round. Arithmetic is done modulo 2^32, which is
+    // exact for the wrapping int products the kernels compute. A wrong C passes
+    // a single round with probability at most 1/2.
+    // seed == 0 draws a fresh seed from std::random_device.
+    bool freivalds_verify(const Matrix& A, const Matrix& B, const Matrix& C,
+                          int rounds = 10, int num_threads = 1, uint64_t seed = 0);
+    // Widened results are checked modulo 2^64
+    bool freivalds_verify(const Matrix& A, const Matrix& B, const Matrix64& C,
+                          int rounds = 10, int num_threads = 1, uint64_t seed = 0);
+
+    // Runs freivalds_verify on every Nth call to check() and throws
+    // std::runtime_error when the product is wrong. Safe to share between threads.
+    class PeriodicVerifier {
+        private:
+            int m_every_n;
+            int m_rounds;
+            int m_num_threads;
+            std::atomic<uint64_t> m_calls{0};
+
+        public:
+            PeriodicVerifier(int every_n, int rounds = 10, int num_threads = 1);
+
+            // Returns true if this call was sampled and verified
+            bool check(const Matrix& A, const Matrix& B, const Matrix& C);
+            uint64_t calls() const;
+    };
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "../includes/auto.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace matmul {
+    // Starting points for the model; observed timings correct them per bucket.
+    // Fork-join overhead and tile throughput come from parallel_cost().
+    static constexpr double CALL_MS = 0.002;         // fixed cost of any call
+    static constexpr double BYTES_PER_MS = 8.0e6;    // streaming bandwidth, one core
+    static constexpr double NAIVE_FLOPS_PER_MS = 1.0e6;
+
+    static int log2_bucket(int x) {
+        int bucket = 0;
+        while ((1 << (bucket + 1)) <= x) ++bucket;
+        return bucket;
+    }
+
+    int block_size_for(const CacheInfo& info, int element_size) {
+        if (info.l1d_size <= 0 || info.line_size <= 0) return 64;
+        const int per_line = std::max(1, static_cast<int>(info.line_size / element_size));
+        const int max_elements = static_cast<int>(info.l1d_size / element_size);
+        int block_size = static_cast<int>(std::sqrt(max_elements / 3)); // For A, B, C
+        block_size = (block_size / per_line) * per_line;
+        return block_size > 0 ? block_size : per_line;
+    }
+
+    AutoTuner::AutoTuner(const CacheInfo& info, int max_threads)
+        : m_info(info), m_block_size(block_size_for(info)) {
+        if (max_threads <= 0) {
+            max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        m_max_threads = max_threads;
+    }
+
+    AutoTuner& AutoTuner::instance() {
+        static AutoTuner tuner;
+        return tuner;
+    }
+
+    double AutoTuner::model_ms(Algorithm algorithm, const Shape& shape, int threads) const {
+        const double work = flops(shape);
+        const ParallelCost& cost = parallel_cost();
+        const double rate = cost.tile_flops_per_ms;
+        const double bytes_b = 4.0 * shape.k * shape.n;
+        switch (algorithm) {
+            case Algorithm::Naive: {
+                // Column walks of B miss on every access once B leaves L2
+                const double l2 = m_info.l2_size > 0 ? m_info.l2_size : 256.0 * 1024;
+                return CALL_MS + work / NAIVE_FLOPS_PER_MS * (bytes_b > l2 ? 4.0 : 1.0);
+            }
+            case Algorithm::Recursive:
+                // Same leaf kernel as blocked, one thread, plus the call tree
+                return CALL_MS + work / rate * 1.05;
+            case Algorithm::Blocked: {
+                // Vector-shaped products are routed to bandwidth-bound kernels
+                const double bytes_a = 4.0 * shape.m * shape.k;
+                const double stream_ms = (bytes_a + bytes_b) / (BYTES_PER_MS * threads);
+                return CALL_MS + (threads > 1 ? threads * cost.fork_join_ms : 0.0) + std::max(work / (rate * threads), stream_ms);
+            }
+        }
+        return std::numeric_limits<double>::max();
+    }
+
+    // Same work-per-thread model matmul_blocked applies to the requested count
+    int AutoTuner::best_threads(const Shape& shape) const {
+        return parallel_threads(shape.m, shape.n, shape.k, m_block_size, m_max_threads);
+    }
+
+    AutoPlan AutoTuner::plan(const Shape& shape, bool transposed_b) {
+        const Bucket bucket{log2_bucket(shape.m), log2_bucket(shape.k), log2_bucket(shape.n)};
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<AutoPlan> candidates;
+        for (auto algorithm : {Algorithm::Naive, Algorithm::Blocked, Algorithm::Recursive}) {
+            if (transposed_b && algorithm == Algorithm::Recursive) continue;
+            const int threads = is_parallel(algorithm) ? best_threads(shape) : 1;
+            const auto feedback = m_feedback.find({bucket, algorithm});
+            const double ratio = feedback == m_feedback.end() ? 1.0 : feedback->second.ratio;
+            candidates.push_back({algorithm, m_block_size, threads, model_ms(algorithm, shape, threads) * ratio});
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const AutoPlan& x, const AutoPlan& y) { return x.predicted_ms < y.predicted_ms; });
+
+        for (const AutoPlan& candidate : candidates) {
+            if (candidate.predicted_ms > candidates.front().predicted_ms * EXPLORE_RATIO) break;
+            if (!m_feedback.count({bucket, candidate.algorithm})) return candidate;
+        }
+        return candidates.front();
+    }
+
+    void AutoTuner::record(const Shape& shape, const AutoPlan& plan, double elapsed_ms) {
+        if (plan.predicted_ms <= 0) return;
+        const Bucket bucket{log2_bucket(shape.m), log2_bucket(shape.k), log2_bucket(shape.n)};
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Feedback& feedback = m_feedback[{bucket, plan.algorithm}];
+        // predicted_ms already includes the old ratio; fold the residual error into it
+        const double observed = feedback.ratio * elapsed_ms / plan.predicted_ms;
+        feedback.ratio = feedback.samples == 0 ? observed
+                                               : (1 - EWMA_WEIGHT) * feedback.ratio + EWMA_WEIGHT * observed;
+        ++feedback.samples;
+    }
+
+    Matrix AutoTuner::multiply(const Matrix& A, const Matrix& B, AutoPlan* used) {
+        const bool transposed_b = B.layout() == Layout::Transposed;
+        const Shape shape{A.get_rows(), A.get_cols(), transposed_b ? B.get_rows() : B.get_cols()};
+        if (A.get_cols() != (transposed_b ? B.get_cols() : B.get_rows())) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const AutoPlan chosen = plan(shape, transposed_b);
+        const auto start = std::chrono::steady_clock::now();
+        Matrix C = chosen.algorithm == Algorithm::Naive ? matmul_naive(A, B)
+                 : chosen.algorithm == Algorithm::Recursive ? matmul_recursive(A, B)
+                 : matmul_blocked(A, B, chosen.block_size, chosen.num_threads);
+        record(shape, chosen, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        if (used) *used = chosen;
+        return C;
+    }
+
+    Matrix matmul_auto(const Matrix& A, const Matrix& B) {
+        return AutoTuner::instance().multiply(A, B);
+    }
+}
@@ -0,0 +1,236 @@
+#include "../includes/bench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace matmul {
+    std::string algorithm_name(Algorithm algorithm) {
+        switch (algorithm) {
+            case Algorithm::Naive: return "Naive";
+            case Algorithm::Blocked: return "Blocked";
+            case Algorithm::Recursive: return "Recursive";
+        }
+        return "Unknown";
+    }
+
+    Algorithm algorithm_from_name(const std::string& name) {
+        for (auto algorithm : {Algorithm::Naive, Algorithm::Blocked, Algorithm::Recursive}) {
+            if (algorithm_name(algorithm) == name) return algorithm;
+        }
+        throw std::invalid_argument("Unknown algorithm: " + name);
+    }
+
+    bool is_parallel(Algorithm algorithm) {
+        return algorithm == Algorithm::Blocked;
+    }
+
+    std::string shape_name(const Shape& shape) {
+        return std::to_string(shape.m) + "x" + std::to_string(shape.k) + "x" + std::to_string(shape.n);
+    }
+
+    double flops(const Shape& shape) {
+        return 2.0 * shape.m * shape.k * shape.n;
+    }
+
+    bool supports(Algorithm, const Shape&) {
+        // Every engine, the recursive one included, handles rectangular shapes
+        return true;
+    }
+
+    double BenchResult::median_ms() const {
+        if (samples_ms.empty()) return 0.0;
+        std::vector<double> sorted = samples_ms;
+        std::sort(sorted.begin(), sorted.end());
+        size_t mid = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+    }
+
+    BenchResult run_benchmark(const BenchCase& bench_case, int block_size, int repeats) {
+        if (!supports(bench_case.algorithm, bench_case.shape)) {
+            throw std::invalid_argument(algorithm_name(bench_case.algorithm) + " does not support shape " +
+                                        shape_name(bench_case.shape));
+        }
+        Matrix A(bench_case.shape.m, bench_case.shape.k);
+        Matrix B(bench_case.shape.k, bench_case.shape.n);
+        A.fill_matrix();
+        B.fill_matrix();
+
+        BenchResult result{bench_case, {}};
+        for (int r = 0; r < std::max(repeats, 1); ++r) {
+            auto start = std::chrono::steady_clock::now();
+            switch (bench_case.algorithm) {
+                case Algorithm::Naive: matmul_naive(A, B); break;
+                case Algorithm::Blocked: matmul_blocked(A, B, block_size, bench_case.threads); break;
+                case Algorithm::Recursive: matmul_recursive(A, B); break;
+            }
+            auto stop = std::chrono::steady_clock::now();
+            result.samples_ms.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+        }
+        return result;
+    }
+
+    Shape weak_scaled(const Shape& base, int threads) {
+        const double factor = std::cbrt(static_cast<double>(std::max(threads, 1)));
+        auto scale = [factor](int dim) { return std::max(1, static_cast<int>(std::lround(dim * factor))); };
+        return {scale(base.m), scale(base.k), scale(base.n)};
+    }
+
+    SweepResult run_sweep(const SweepConfig& config) {
+        SweepResult sweep;
+        for (const auto& shape : config.shapes) {
+            for (auto algorithm : config.algorithms) {
+                if (!supports(algorithm, shape)) continue;
+                if (!is_parallel(algorithm)) {
+                    BenchResult single = run_benchmark({algorithm, shape, 1}, config.block_size, config.repeats);
+                    for (int threads : config.thread_counts) {
+                        single.bench_case.threads = threads;
+                        sweep.strong.push_back(single);
+                    }
+                    continue;
+                }
+                for (int threads : config.thread_counts) {
+                    sweep.strong.push_back(run_benchmark({algorithm, shape, threads}, config.block_size, config.repeats));
+                }
+            }
+        }
+        for (const auto& base : config.shapes) {
+            for (auto algorithm : config.algorithms) {
+                if (!is_parallel(algorithm) || !supports(algorithm, base)) continue;
+                for (int threads : config.thread_counts) {
+                    Shape scaled = weak_scaled(base, threads);
+                    BenchResult result = run_benchmark({algorithm, scaled, threads}, config.block_size, config.repeats);
+                    result.bench_case.shape = base; // keyed by the base shape
+                    sweep.weak.push_back(result);
+                }
+            }
+        }
+        return sweep;
+    }
+
+    const BenchResult* find_result(const std::vector<BenchResult>& results, Algorithm algorithm,
+                                   const Shape& shape, int threads) {
+        for (const auto& result : results) {
+            const auto& c = result.bench_case;
+            if (c.algorithm == algorithm && c.threads == threads &&
+                c.shape.m == shape.m && c.shape.k == shape.k && c.shape.n == shape.n) {
+                return &result;
+            }
+        }
+        return nullptr;
+    }
+
+    void save_baseline(const std::string& path, const Baseline& baseline) {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Cannot write baseline file: " + path);
+        }
+        out << "# matmul baseline: algorithm m k n threads samples_ms...\n";
+        out << "block_size " << baseline.block_size << "\n";
+        for (const auto& result : baseline.results) {
+            const auto& c = result.bench_case;
+            out << algorithm_name(c.algorithm) << ' ' << c.shape.m << ' ' << c.shape.k << ' '
+                << c.shape.n << ' ' << c.threads;
+            for (double sample : result.samples_ms) out << ' ' << sample;
+            out << '\n';
+        }
+    }
+
+    Baseline load_baseline(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot read baseline file: " + path);
+        }
+        Baseline baseline{0, {}};
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            std::string name;
+            fields >> name;
+            if (name == "block_size") {
+                fields >> baseline.block_size;
+                continue;
+            }
+            BenchResult result{{algorithm_from_name(name), {}, 0}, {}};
+            auto& c = result.bench_case;
+            if (!(fields >> c.shape.m >> c.shape.k >> c.shape.n >> c.threads)) {
+                throw std::runtime_error("Malformed baseline line: " + line);
+            }
+            double sample;
+            while (fields >> sample) result.samples_ms.push_back(sample);
+            if (result.samples_ms.empty()) {
+                throw std::runtime_error("Baseline line has no samples: " + line);
+            }
+            baseline.results.push_back(result);
+        }
+        if (baseline.block_size <= 0) {
+            throw std::runtime_error("Baseline file has no block_size: " + path);
+        }
+        return baseline;
+    }
+
+    std::vector<BenchResult> rerun_baseline(const Baseline& baseline) {
+        std::vector<BenchResult> current;
+        for (const auto& result : baseline.results) {
+            current.push_back(run_benchmark(result.bench_case, baseline.block_size,
+                                            static_cast<int>(result.samples_ms.size())));
+        }
+        return current;
+    }
+
+    double mann_whitney_p(const std::vector<double>& baseline, const std::vector<double>& current) {
+        const double n1 = static_cast<double>(baseline.size());
+        const double n2 = static_cast<double>(current.size());
+        if (baseline.empty() || current.empty()) return 1.0;
+
+        // Rank the pooled samples, averaging ranks over ties
+        std::vector<std::pair<double, bool>> pooled; // value, is_current
+        for (double v : baseline) pooled.push_back({v, false});
+        for (double v : current) pooled.push_back({v, true});
+        std::sort(pooled.begin(), pooled.end());
+
+        double rank_sum_current = 0.0;
+        double tie_term = 0.0;
+        for (size_t i = 0; i < pooled.size();) {
+            size_t j = i;
+            while (j < pooled.size() && pooled[j].first == pooled[i].first) ++j;
+            const double average_rank = (i + 1 + j) / 2.0;
+            const double ties = static_cast<double>(j - i);
+            tie_term += ties * ties * ties - ties;
+            for (size_t t = i; t < j; ++t) {
+                if (pooled[t].second) rank_sum_current += average_rank;
+            }
+            i = j;
+        }
+
+        const double u = rank_sum_current - n2 * (n2 + 1) / 2.0;
+        const double n = n1 + n2;
+        const double mean = n1 * n2 / 2.0;
+        const double variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+        if (variance <= 0.0) return 1.0;
+        const double z = (u - mean - 0.5) / std::sqrt(variance); // continuity correction
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+
+    std::vector<Comparison> compare_results(const std::vector<BenchResult>& baseline,
+                                            const std::vector<BenchResult>& current,
+                                            double threshold_pct, double alpha) {
+        std::vector<Comparison> comparisons;
+        for (const auto& base : baseline) {
+            const auto& c = base.bench_case;
+            const BenchResult* now = find_result(current, c.algorithm, c.shape, c.threads);
+            if (!now) continue;
+            Comparison cmp{c, base.median_ms(), now->median_ms(), 0.0, 1.0, false};
+            if (cmp.baseline_ms > 0.0) {
+                cmp.delta_pct = (cmp.current_ms - cmp.baseline_ms) / cmp.baseline_ms * 100.0;
+            }
+            cmp.p_value = mann_whitney_p(base.samples_ms, now->samples_ms);
+            cmp.regressed = cmp.delta_pct > threshold_pct && cmp.p_value < alpha;
+            comparisons.push_back(cmp);
+        }
+        return comparisons;
+    }
+}
@@ -0,0 +1,211 @@
+#include "../includes/cache_sim.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace matmul {
+    constexpr uint64_t INVALID_TAG = std::numeric_limits<uint64_t>::max();
+
+    CacheSimulator::CacheSimulator(const std::vector<CacheLevelConfig>& levels) {
+        if (levels.empty()) {
+            throw std::invalid_argument("Cache model needs at least one level");
+        }
+        for (const auto& config : levels) {
+            if (config.line_size == 0 || config.associativity == 0 ||
+                config.size_bytes < config.line_size * config.associativity) {
+                throw std::invalid_argument("Invalid cache level configuration: " + config.name);
+            }
+            Level level;
+            level.config = config;
+            level.num_sets = config.size_bytes / (config.line_size * config.associativity);
+            level.tags.assign(level.num_sets * config.associativity, INVALID_TAG);
+            level.stamps.assign(level.num_sets * config.associativity, 0);
+            m_levels.push_back(std::move(level));
+        }
+    }
+
+    void CacheSimulator::access(uint64_t address) {
+        ++m_clock;
+        for (auto& level : m_levels) {
+            const uint64_t line = address / level.config.line_size;
+            const size_t ways = level.config.associativity;
+            const size_t base = static_cast<size_t>(line % level.num_sets) * ways;
+            ++level.accesses;
+
+            size_t victim = base;
+            for (size_t w = base; w < base + ways; ++w) {
+                if (level.tags[w] == line) {
+                    level.stamps[w] = m_clock;
+                    return; // hit: upper levels already hold the line
+                }
+                if (level.stamps[w] < level.stamps[victim]) victim = w;
+            }
+            ++level.misses;
+            level.tags[victim] = line;
+            level.stamps[victim] = m_clock;
+        }
+    }
+
+    void CacheSimulator::reset() {
+        m_clock = 0;
+        for (auto& level : m_levels) {
+            std::fill(level.tags.begin(), level.tags.end(), INVALID_TAG);
+            std::fill(level.stamps.begin(), level.stamps.end(), 0);
+            level.accesses = 0;
+            level.misses = 0;
+        }
+    }
+
+    std::vector<CacheLevelStats> CacheSimulator::stats() const {
+        std::vector<CacheLevelStats> result;
+        for (const auto& level : m_levels) {
+            result.push_back({level.config.name, level.accesses, level.misses});
+        }
+        return result;
+    }
+
+    std::vector<CacheLevelConfig> cache_levels_from(const CacheInfo& info) {
+        const size_t line = info.line_size > 0 ? static_cast<size_t>(info.line_size) : CACHE_LINE_SIZE;
+        std::vector<CacheLevelConfig> levels;
+        if (info.l1d_size > 0) levels.push_back({"L1D", static_cast<size_t>(info.l1d_size), line, 8});
+        if (info.l2_size > 0) levels.push_back({"L2", static_cast<size_t>(info.l2_size), line, 16});
+        if (info.l3_size > 0) levels.push_back({"L3", static_cast<size_t>(info.l3_size), line, 16});
+        return levels;
+    }
+
+    // Each operand sits at a fixed synthetic base, so the set mapping, and with it the
+    // miss counts, do not depend on where the allocator or ASLR placed the buffers
+    constexpr uint64_t BASE_A = 1ULL << 40;
+    constexpr uint64_t BASE_B = 2ULL << 40;
+    constexpr uint64_t BASE_C = 3ULL << 40;
+
+    static uint64_t address_of(uint64_t base, const Matrix& M, int i, int j) {
+        return base + (static_cast<uint64_t>(i) * M.row_stride() + j) * sizeof(int);
+    }
+
+    std::vector<CacheLevelStats> simulate_naive(const Matrix& A, const Matrix& B,
+                                                const std::vector<CacheLevelConfig>& levels) {
+        const bool bt = B.layout() == Layout::Transposed;
+        const int n = bt ? B.get_rows() : B.get_cols();
+        if (A.get_cols() != (bt ? B.get_cols() : B.get_rows())) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        CacheSimulator sim(levels);
+        Matrix C(A.get_rows(), n);
+        for (int i = 0; i < A.get_rows(); i++) {
+            for (int j = 0; j < n; j++) {
+                for (int k = 0; k < A.get_cols(); k++) {
+                    sim.access(address_of(BASE_A, A, i, k));
+                    sim.access(bt ? address_of(BASE_B, B, j, k) : address_of(BASE_B, B, k, j));
+                }
+                sim.access(address_of(BASE_C, C, i, j));
+            }
+        }
+        return sim.stats();
+    }
+
+    std::vector<CacheLevelStats> simulate_blocked(const Matrix& A, const Matrix& B, int block_size,
+                                                  const std::vector<CacheLevelConfig>& levels) {
+        const bool bt = B.layout() == Layout::Transposed;
+        if (A.get_cols() != (bt ? B.get_cols() : B.get_rows())) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int m = A.get_rows();
+        const int n = bt ? B.get_rows() : B.get_cols();
+        const int depth = A.get_cols();
+        int threads = 1;
+        normalize_blocking(m, n, depth, block_size, threads);
+        const TileOccupancy occupied_a(A, block_size);
+        const TileOccupancy occupied_b(B, block_size);
+
+        CacheSimulator sim(levels);
+        Matrix C(m, n);
+        for (int i = 0; i < m; i += block_size) {
+            for (int j = 0; j < n; j += block_size) {
+                int i_max = std::min(i + block_size, m);
+                int j_max = std::min(j + block_size, n);
+                for (int ii = i; ii < i_max; ++ii) {
+                    for (int jj = j; jj < j_max; ++jj) {
+                        sim.access(address_of(BASE_C, C, ii, jj));
+                    }
+                }
+                for (int k = 0; k < depth; k += block_size) {
+                    const bool b_occupied = bt ? occupied_b.occupied(j / block_size, k / block_size)
+                                               : occupied_b.occupied(k / block_size, j / block_size);
+                    if (!occupied_a.occupied(i / block_size, k / block_size) || !b_occupied) {
+                        continue;
+                    }
+                    int k_max = std::min(k + block_size, depth);
+                    if (bt) {
+                        // B^T tile kernel: one unit-stride dot product per C element
+                        for (int ii = i; ii < i_max; ++ii) {
+                            for (int jj = j; jj < j_max; ++jj) {
+                                for (int kk = k; kk < k_max; ++kk) {
+                                    sim.access(address_of(BASE_A, A, ii, kk));
+                                    sim.access(address_of(BASE_B, B, jj, kk));
+                                }
+                                sim.access(address_of(BASE_C, C, ii, jj));
+                            }
+                        }
+                        continue;
+                    }
+                    for (int ii = i; ii < i_max; ++ii) {
+                        for (int kk = k; kk < k_max; ++kk) {
+                            sim.access(address_of(BASE_A, A, ii, kk));
+                            for (int jj = j; jj < j_max; ++jj) {
+                                sim.access(address_of(BASE_B, B, kk, jj));
+                                sim.access(address_of(BASE_C, C, ii, jj));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return sim.stats();
+    }
+
+    // Mirrors matmul_recursive: the same splits, and the tile kernel's row-axpy order at the leaves
+    static void simulate_recursive_helper(CacheSimulator& sim, const Matrix& A, const Matrix& B, Matrix& C,
+                                          int rA, int cA, int rB, int cB, int m, int depth, int n, int cutoff) {
+        if (m <= cutoff && depth <= cutoff && n <= cutoff) {
+            for (int i = 0; i < m; i++) {
+                for (int k = 0; k < depth; k++) {
+                    sim.access(address_of(BASE_A, A, rA + i, cA + k));
+                    for (int j = 0; j < n; j++) {
+                        sim.access(address_of(BASE_B, B, rB + k, cB + j));
+                        sim.access(address_of(BASE_C, C, rA + i, cB + j));
+                    }
+                }
+            }
+            return;
+        }
+        if (m >= depth && m >= n) {
+            const int half = m / 2;
+            simulate_recursive_helper(sim, A, B, C, rA, cA, rB, cB, half, depth, n, cutoff);
+            simulate_recursive_helper(sim, A, B, C, rA + half, cA, rB, cB, m - half, depth, n, cutoff);
+        } else if (n >= depth) {
+            const int half = n / 2;
+            simulate_recursive_helper(sim, A, B, C, rA, cA, rB, cB, m, depth, half, cutoff);
+            simulate_recursive_helper(sim, A, B, C, rA, cA, rB, cB + half, m, depth, n - half, cutoff);
+        } else {
+            const int half = depth / 2;
+            simulate_recursive_helper(sim, A, B, C, rA, cA, rB, cB, m, half, n, cutoff);
+            simulate_recursive_helper(sim, A, B, C, rA, cA + half, rB + half, cB, m, depth - half, n, cutoff);
+        }
+    }
+
+    std::vector<CacheLevelStats> simulate_recursive(const Matrix& A, const Matrix& B,
+                                                    const std::vector<CacheLevelConfig>& levels, int cutoff) {
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("simulate_recursive does not support transposed operands");
+        }
+        if (A.get_cols() != B.get_rows()) {
+            throw std::runtime_error("Matrix dimensions do not match for multiplication");
+        }
+        CacheSimulator sim(levels);
+        Matrix C(A.get_rows(), B.get_cols());
+        simulate_recursive_helper(sim, A, B, C, 0, 0, 0, 0, A.get_rows(), A.get_cols(), B.get_cols(),
+                                  cutoff > 0 ? cutoff : recursive_cutoff());
+        return sim.stats();
+    }
+}
@@ -0,0 +1,135 @@
+#include "../includes/chain.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace matmul {
+    MatrixPool::MatrixPool(size_t max_free) : m_max_free(max_free) {}
+
+    Matrix MatrixPool::acquire(int rows, int cols) {
+        const size_t needed = static_cast<size_t>(rows) * Matrix::padded_stride(cols);
+        // Smallest free buffer that can hold the result without reallocating
+        auto best = m_free.end();
+        for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+            if (it->capacity() >= needed && (best == m_free.end() || it->capacity() < best->capacity())) {
+                best = it;
+            }
+        }
+        if (best == m_free.end()) {
+            ++m_allocations;
+            return Matrix(rows, cols);
+        }
+        Matrix M = std::move(*best);
+        m_free.erase(best);
+        M.resize(rows, cols);
+        M.set_layout(Layout::RowMajor);
+        return M;
+    }
+
+    void MatrixPool::release(Matrix&& M) {
+        m_free.push_back(std::move(M));
+        // Oldest first: a buffer no recent request has fit goes before one just returned
+        if (m_free.size() > m_max_free) m_free.erase(m_free.begin());
+    }
+
+    size_t MatrixPool::allocations() const {
+        return m_allocations;
+    }
+
+    ChainPlan plan_chain(const std::vector<int>& dims, int num_threads, double traffic_weight) {
+        if (dims.size() < 2) {
+            throw std::invalid_argument("Matrix chain needs at least one matrix");
+        }
+        for (int d : dims) {
+            if (d <= 0) throw std::invalid_argument("Matrix dimensions must be positive");
+        }
+        const int count = static_cast<int>(dims.size()) - 1;
+        auto product_cost = [&](int i, int s, int j, double& flops) {
+            const double m = dims[i], k = dims[s + 1], n = dims[j + 1];
+            flops = 2.0 * m * k * n;
+            return flops + traffic_weight * (m * k + k * n + m * n);
+        };
+
+        // cost[i][j] / flops[i][j] for the sub-chain M_i..M_j, split[i][j] where it is cut
+        std::vector<std::vector<double>> cost(count, std::vector<double>(count, 0.0));
+        std::vector<std::vector<double>> total_flops(count, std::vector<double>(count, 0.0));
+        std::vector<std::vector<int>> split(count, std::vector<int>(count, -1));
+        for (int length = 2; length <= count; ++length) {
+            for (int i = 0; i + length - 1 < count; ++i) {
+                const int j = i + length - 1;
+                cost[i][j] = std::numeric_limits<double>::infinity();
+                for (int s = i; s < j; ++s) {
+                    double flops;
+                    double c = cost[i][s] + cost[s + 1][j] + product_cost(i, s, j, flops);
+                    if (c < cost[i][j]) {
+                        cost[i][j] = c;
+                        total_flops[i][j] = total_flops[i][s] + total_flops[s + 1][j] + flops;
+                        split[i][j] = s;
+                    }
+                }
+            }
+        }
+
+        ChainPlan plan{{}, total_flops[0][count - 1], cost[0][count - 1], ""};
+        std::function<std::string(int, int)> emit = [&](int i, int j) -> std::string {
+            if (i == j) return "M" + std::to_string(i);
+            const int s = split[i][j];
+            std::string text = "(" + emit(i, s) + " " + emit(s + 1, j) + ")";
+            const int m = dims[i], k = dims[s + 1], n = dims[j + 1];
+            plan.steps.push_back({i, s, j, m, k, n, std::max(num_threads, 1)});
+            return text;
+        };
+        plan.parenthesization = emit(0, count - 1);
+        return plan;
+    }
+
+    Matrix matmul_chain(const std::vector<Matrix>& matrices, int block_size, int num_threads,
+                        MatrixPool* pool, double traffic_weight) {
+        if (matrices.empty()) {
+            throw std::invalid_argument("Matrix chain needs at least one matrix");
+        }
+        std::vector<int> dims = {matrices.front().get_rows()};
+        for (const auto& M : matrices) {
+            if (M.layout() != Layout::RowMajor) {
+                throw std::invalid_argument("Matrix chain does not support transposed operands");
+            }
+            if (M.get_rows() != dims.back()) {
+                throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+            }
+            dims.push_back(M.get_cols());
+        }
+        if (matrices.size() == 1) return matrices.front();
+
+        MatrixPool local_pool;
+        if (!pool) pool = &local_pool;
+        const ChainPlan plan = plan_chain(dims, num_threads, traffic_weight);
+
+        // Intermediate results keyed by the sub-chain they hold; inputs are used in place
+        const int count = static_cast<int>(matrices.size());
+        std::vector<std::vector<Matrix*>> partial(count, std::vector<Matrix*>(count, nullptr));
+        std::vector<std::unique_ptr<Matrix>> owned;
+        auto operand = [&](int i, int j) -> const Matrix& {
+            return i == j ? matrices[i] : *partial[i][j];
+        };
+        auto recycle = [&](int i, int j) {
+            if (i == j) return;
+            pool->release(std::move(*partial[i][j]));
+            partial[i][j] = nullptr;
+        };
+
+        for (const auto& step : plan.steps) {
+            // The result leaves with the caller, so only intermediates come from the pool
+            const bool last = &step == &plan.steps.back();
+            owned.push_back(std::make_unique<Matrix>(last ? Matrix(step.m, step.n) : pool->acquire(step.m, step.n)));
+            Matrix& out = *owned.back();
+            matmul_blocked_into(operand(step.first, step.split), operand(step.split + 1, step.last),
+                                out, block_size, step.num_threads);
+            recycle(step.first, step.split);
+            recycle(step.split + 1, step.last);
+            partial[step.first][step.last] = &out;
+        }
+        return std::move(*partial[0][count - 1]);
+    }
+}
@@ -0,0 +1,346 @@
+#include "../includes/dispatch.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATMUL_X86_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace matmul {
+    std::string isa_name(Isa isa) {
+        switch (isa) {
+            case Isa::Scalar: return "scalar";
+            case Isa::SSE41: return "sse4.1";
+            case Isa::AVX2: return "avx2";
+            case Isa::AVX512: return "avx512";
+        }
+        return "unknown";
+    }
+
+    CpuFeatures detect_cpu_features() {
+        CpuFeatures features = {false, false, false};
+#ifdef MATMUL_X86_DISPATCH
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return features;
+        features.sse41 = (ecx & bit_SSE4_1) != 0;
+
+        // AVX state must be enabled by the OS (OSXSAVE + XCR0) before AVX2/AVX-512 are usable
+        const bool osxsave = (ecx & bit_OSXSAVE) != 0;
+        if (!osxsave || !(ecx & bit_AVX)) return features;
+        uint32_t xcr0_lo, xcr0_hi;
+        __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        const bool ymm_state = (xcr0_lo & 0x6) == 0x6;
+        const bool zmm_state = (xcr0_lo & 0xe6) == 0xe6;
+
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            features.avx2 = ymm_state && (ebx & bit_AVX2) != 0;
+            features.avx512f = zmm_state && (ebx & bit_AVX512F) != 0;
+        }
+#endif
+        return features;
+    }
+
+    Isa best_isa(const CpuFeatures& features) {
+        if (features.avx512f) return Isa::AVX512;
+        if (features.avx2) return Isa::AVX2;
+        if (features.sse41) return Isa::SSE41;
+        return Isa::Scalar;
+    }
+
+    static void axpy_scalar(int* c, const int* b, int a, int len) {
+        for (int j = 0; j < len; ++j) c[j] += a * b[j];
+    }
+
+    static void tile_scalar(const int* a, size_t lda, const int* b, size_t ldb,
+                            int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < depth; ++k) {
+                axpy_scalar(c + i * ldc, b + k * ldb, a[i * lda + k], cols);
+            }
+        }
+    }
+
+    static void tile_wide_scalar(const int* a, size_t lda, const int* b, size_t ldb,
+                                 int64_t* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < depth; ++k) {
+                const int64_t a_ik = a[i * lda + k];
+                const int* b_row = b + k * ldb;
+                int64_t* c_row = c + i * ldc;
+                for (int j = 0; j < cols; ++j) c_row[j] += a_ik * b_row[j];
+            }
+        }
+    }
+
+    static int dot_scalar(const int* a, const int* b, int len) {
+        int sum = 0;
+        for (int k = 0; k < len; ++k) sum += a[k] * b[k];
+        return sum;
+    }
+
+    static void tile_bt_scalar(const int* a, size_t lda, const int* bt, size_t ldbt,
+                               int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                c[i * ldc + j] += dot_scalar(a + i * lda, bt + j * ldbt, depth);
+            }
+        }
+    }
+
+#ifdef MATMUL_X86_DISPATCH
+    __attribute__((target("sse4.1")))
+    static inline int dot_sse41(const int* a, const int* b, int len) {
+        __m128i acc = _mm_setzero_si128();
+        int k = 0;
+        for (; k + 4 <= len; k += 4) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + k));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + k));
+            acc = _mm_add_epi32(acc, _mm_mullo_epi32(va, vb));
+        }
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        int sum = _mm_cvtsi128_si32(acc);
+        for (; k < len; ++k) sum += a[k] * b[k];
+        return sum;
+    }
+
+    __attribute__((target("sse4.1")))
+    static void tile_bt_sse41(const int* a, size_t lda, const int* bt, size_t ldbt,
+                              int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                c[i * ldc + j] += dot_sse41(a + i * lda, bt + j * ldbt, depth);
+            }
+        }
+    }
+
+    __attribute__((target("sse4.1")))
+    static inline void axpy_sse41(int* c, const int* b, int a, int len) {
+        const __m128i va = _mm_set1_epi32(a);
+        int j = 0;
+        for (; j + 4 <= len; j += 4) {
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + j));
+            vc = _mm_add_epi32(vc, _mm_mullo_epi32(va, vb));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(c + j), vc);
+        }
+        for (; j < len; ++j) c[j] += a * b[j];
+    }
+
+    __attribute__((target("sse4.1")))
+    static void tile_sse41(const int* a, size_t lda, const int* b, size_t ldb,
+                           int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < depth; ++k) {
+                axpy_sse41(c + i * ldc, b + k * ldb, a[i * lda + k], cols);
+            }
+        }
+    }
+
+    // _mm_mul_epi32 multiplies the low signed 32 bits of each 64-bit lane into a full 64-bit product
+    __attribute__((target("sse4.1")))
+    static void tile_wide_sse41(const int* a, size_t lda, const int* b, size_t ldb,
+                                int64_t* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            int64_t* c_row = c + i * ldc;
+            for (int k = 0; k < depth; ++k) {
+                const int a_ik = a[i * lda + k];
+                const int* b_row = b + k * ldb;
+                const __m128i va = _mm_set1_epi64x(a_ik);
+                int j = 0;
+                for (; j + 2 <= cols; j += 2) {
+                    __m128i vb = _mm_cvtepi32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b_row + j)));
+                    __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c_row + j));
+                    vc = _mm_add_epi64(vc, _mm_mul_epi32(va, vb));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(c_row + j), vc);
+                }
+                for (; j < cols; ++j) c_row[j] += static_cast<int64_t>(a_ik) * b_row[j];
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static inline void axpy_avx2(int* c, const int* b, int a, int len) {
+        const __m256i va = _mm256_set1_epi32(a);
+        int j = 0;
+        for (; j + 8 <= len; j += 8) {
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+            __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + j));
+            vc = _mm256_add_epi32(vc, _mm256_mullo_epi32(va, vb));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + j), vc);
+        }
+        for (; j < len; ++j) c[j] += a * b[j];
+    }
+
+    __attribute__((target("avx2")))
+    static void tile_avx2(const int* a, size_t lda, const int* b, size_t ldb,
+                          int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < depth; ++k) {
+                axpy_avx2(c + i * ldc, b + k * ldb, a[i * lda + k], cols);
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static inline int dot_avx2(const int* a, const int* b, int len) {
+        __m256i acc = _mm256_setzero_si256();
+        int k = 0;
+        for (; k + 8 <= len; k += 8) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + k));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(va, vb));
+        }
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+        int sum = _mm_cvtsi128_si32(half);
+        for (; k < len; ++k) sum += a[k] * b[k];
+        return sum;
+    }
+
+    __attribute__((target("avx2")))
+    static void tile_bt_avx2(const int* a, size_t lda, const int* bt, size_t ldbt,
+                             int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                c[i * ldc + j] += dot_avx2(a + i * lda, bt + j * ldbt, depth);
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void tile_wide_avx2(const int* a, size_t lda, const int* b, size_t ldb,
+                               int64_t* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            int64_t* c_row = c + i * ldc;
+            for (int k = 0; k < depth; ++k) {
+                const int a_ik = a[i * lda + k];
+                const int* b_row = b + k * ldb;
+                const __m256i va = _mm256_set1_epi64x(a_ik);
+                int j = 0;
+                for (; j + 4 <= cols; j += 4) {
+                    __m256i vb = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b_row + j)));
+                    __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c_row + j));
+                    vc = _mm256_add_epi64(vc, _mm256_mul_epi32(va, vb));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(c_row + j), vc);
+                }
+                for (; j < cols; ++j) c_row[j] += static_cast<int64_t>(a_ik) * b_row[j];
+            }
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static inline void axpy_avx512(int* c, const int* b, int a, int len) {
+        const __m512i va = _mm512_set1_epi32(a);
+        int j = 0;
+        for (; j + 16 <= len; j += 16) {
+            __m512i vb = _mm512_loadu_si512(b + j);
+            __m512i vc = _mm512_loadu_si512(c + j);
+            vc = _mm512_add_epi32(vc, _mm512_mullo_epi32(va, vb));
+            _mm512_storeu_si512(c + j, vc);
+        }
+        if (j < len) {
+            const __mmask16 mask = static_cast<__mmask16>((1u << (len - j)) - 1);
+            __m512i vb = _mm512_maskz_loadu_epi32(mask, b + j);
+            __m512i vc = _mm512_maskz_loadu_epi32(mask, c + j);
+            vc = _mm512_add_epi32(vc, _mm512_mullo_epi32(va, vb));
+            _mm512_mask_storeu_epi32(c + j, mask, vc);
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void tile_avx512(const int* a, size_t lda, const int* b, size_t ldb,
+                            int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < depth; ++k) {
+                axpy_avx512(c + i * ldc, b + k * ldb, a[i * lda + k], cols);
+            }
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static inline int dot_avx512(const int* a, const int* b, int len) {
+        __m512i acc = _mm512_setzero_si512();
+        int k = 0;
+        for (; k + 16 <= len; k += 16) {
+            acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(_mm512_loadu_si512(a + k), _mm512_loadu_si512(b + k)));
+        }
+        if (k < len) {
+            const __mmask16 mask = static_cast<__mmask16>((1u << (len - k)) - 1);
+            __m512i va = _mm512_maskz_loadu_epi32(mask, a + k);
+            __m512i vb = _mm512_maskz_loadu_epi32(mask, b + k);
+            acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(va, vb));
+        }
+        return _mm512_reduce_add_epi32(acc);
+    }
+
+    __attribute__((target("avx512f")))
+    static void tile_bt_avx512(const int* a, size_t lda, const int* bt, size_t ldbt,
+                               int* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                c[i * ldc + j] += dot_avx512(a + i * lda, bt + j * ldbt, depth);
+            }
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void tile_wide_avx512(const int* a, size_t lda, const int* b, size_t ldb,
+                                 int64_t* c, size_t ldc, int rows, int depth, int cols) {
+        for (int i = 0; i < rows; ++i) {
+            int64_t* c_row = c + i * ldc;
+            for (int k = 0; k < depth; ++k) {
+                const int a_ik = a[i * lda + k];
+                const int* b_row = b + k * ldb;
+                const __m512i va = _mm512_set1_epi64(a_ik);
+                int j = 0;
+                for (; j + 8 <= cols; j += 8) {
+                    __m512i vb = _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_row + j)));
+                    __m512i vc = _mm512_loadu_si512(c_row + j);
+                    vc = _mm512_add_epi64(vc, _mm512_mul_epi32(va, vb));
+                    _mm512_storeu_si512(c_row + j, vc);
+                }
+                for (; j < cols; ++j) c_row[j] += static_cast<int64_t>(a_ik) * b_row[j];
+            }
+        }
+    }
+#endif
+
+    KernelTable kernels_for(Isa isa) {
+#ifdef MATMUL_X86_DISPATCH
+        switch (isa) {
+            case Isa::AVX512: return {Isa::AVX512, axpy_avx512, tile_avx512, tile_wide_avx512, dot_avx512, tile_bt_avx512};
+            case Isa::AVX2: return {Isa::AVX2, axpy_avx2, tile_avx2, tile_wide_avx2, dot_avx2, tile_bt_avx2};
+            case Isa::SSE41: return {Isa::SSE41, axpy_sse41, tile_sse41, tile_wide_sse41, dot_sse41, tile_bt_sse41};
+            case Isa::Scalar: break;
+        }
+#else
+        (void)isa;
+#endif
+        return {Isa::Scalar, axpy_scalar, tile_scalar, tile_wide_scalar, dot_scalar, tile_bt_scalar};
+    }
+
+    static Isa resolve_isa() {
+        const Isa supported = best_isa(detect_cpu_features());
+        const char* env = std::getenv("MATMUL_ISA");
+        if (!env) return supported;
+
+        std::string requested(env);
+        std::transform(requested.begin(), requested.end(), requested.begin(),
+                       [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+        for (Isa isa : {Isa::Scalar, Isa::SSE41, Isa::AVX2, Isa::AVX512}) {
+            if (isa_name(isa) == requested) return std::min(isa, supported);
+        }
+        return supported; // unknown names are ignored
+    }
+
+    const KernelTable& kernels() {
+        static const KernelTable table = kernels_for(resolve_isa());
+        return table;
+    }
+}
@@ -0,0 +1,436 @@
+#include "../includes/distributed.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#if defined(__unix__) || defined(__APPLE__)
+#define MATMUL_POSIX_PROCESSES
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace matmul {
+    #ifdef MATMUL_POSIX_PROCESSES
+    #ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+    #endif
+
+    using Clock = std::chrono::steady_clock;
+
+    static double elapsed_ms(Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+
+    static void write_all(int fd, const void* data, size_t bytes) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const ssize_t sent = send(fd, p, bytes, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) throw std::runtime_error(std::string("Distributed send failed: ") + std::strerror(errno));
+            p += sent;
+            bytes -= static_cast<size_t>(sent);
+        }
+    }
+
+    static void read_all(int fd, void* data, size_t bytes) {
+        char* p = static_cast<char*>(data);
+        while (bytes > 0) {
+            const ssize_t got = recv(fd, p, bytes, 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got == 0) throw std::runtime_error("Distributed peer closed the connection");
+            if (got < 0) throw std::runtime_error(std::string("Distributed receive failed: ") + std::strerror(errno));
+            p += got;
+            bytes -= static_cast<size_t>(got);
+        }
+    }
+
+    // A rank's view of the socket mesh: one stream per connected peer. Sends and
+    // receives may run on different threads; each counter has a single writer.
+    struct Mesh {
+        int rank;
+        std::vector<int> fds; // -1 for self and unconnected ranks
+        uint64_t bytes_sent = 0;
+        uint64_t bytes_received = 0;
+
+        // Blocks travel as unaligned matrices, so rows are contiguous
+        void send(int peer, const Matrix& M) {
+            const size_t bytes = sizeof(int) * M.get_rows() * M.get_cols();
+            write_all(fds[peer], M.data(), bytes);
+            bytes_sent += bytes;
+        }
+
+        void recv(int peer, Matrix& M) {
+            const size_t bytes = sizeof(int) * M.get_rows() * M.get_cols();
+            read_all(fds[peer], M.data(), bytes);
+            bytes_received += bytes;
+        }
+    };
+
+    struct RankReport {
+        double compute_ms = 0;
+        double comm_ms = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t bytes_received = 0;
+    };
+
+    // What a rank hands back to the caller: optionally its block of C at (row0, col0)
+    struct RankOutput {
+        RankReport report;
+        bool has_block = false;
+        int row0 = 0, col0 = 0;
+        Matrix block{1, 1, false};
+    };
+
+    // Copy of M's [r0, r1) x [c0, c1) with contiguous rows
+    static Matrix block_of(const Matrix& M, int r0, int r1, int c0, int c1) {
+        Matrix block(r1 - r0, c1 - c0, false);
+        for (int i = r0; i < r1; ++i) {
+            std::memcpy(block.data() + static_cast<size_t>(i - r0) * block.get_cols(),
+                        M.data() + i * M.row_stride() + c0, sizeof(int) * block.get_cols());
+        }
+        return block;
+    }
+
+    // Split of `size` into `parts` nearly equal ranges: [offset(i), offset(i + 1))
+    static int offset(int size, int parts, int i) {
+        return static_cast<int>(static_cast<long>(size) * i / parts);
+    }
+
+    static void send_output(int fd, const RankOutput& out) {
+        const int ok = 1;
+        write_all(fd, &ok, sizeof(ok));
+        write_all(fd, &out.report, sizeof(out.report));
+        const int header[5] = {out.has_block, out.row0, out.col0, out.block.get_rows(), out.block.get_cols()};
+        write_all(fd, header, sizeof(header));
+        if (out.has_block) {
+            write_all(fd, out.block.data(), sizeof(int) * out.block.get_rows() * out.block.get_cols());
+        }
+    }
+
+    static void send_error(int fd, const std::string& message) {
+        const int failed = 0;
+        const int length = static_cast<int>(message.size());
+        write_all(fd, &failed, sizeof(failed));
+        write_all(fd, &length, sizeof(length));
+        write_all(fd, message.data(), message.size());
+    }
+
+    // Forks `ranks` processes connected wherever connected(a, b) holds, runs body in
+    // each, and copies the returned blocks into C
+    static void run_ranks(int ranks, const std::function<bool(int, int)>& connected,
+                          const std::function<RankOutput(Mesh&)>& body,
+                          Matrix& C, DistributedStats* stats) {
+        const Clock::time_point start = Clock::now();
+        std::vector<std::vector<int>> mesh(ranks, std::vector<int>(ranks, -1));
+        std::vector<int> to_parent(ranks, -1), to_child(ranks, -1);
+        std::vector<int> all_fds;
+        auto close_all = [&] {
+            for (int fd : all_fds) close(fd);
+        };
+        auto make_pair = [&](int& a, int& b) {
+            int sv[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+                close_all();
+                throw std::runtime_error(std::string("socketpair failed: ") + std::strerror(errno));
+            }
+            a = sv[0];
+            b = sv[1];
+            all_fds.push_back(sv[0]);
+            all_fds.push_back(sv[1]);
+        };
+        for (int a = 0; a < ranks; ++a) {
+            for (int b = a + 1; b < ranks; ++b) {
+                if (connected(a, b)) make_pair(mesh[a][b], mesh[b][a]);
+            }
+            make_pair(to_parent[a], to_child[a]);
+        }
+
+        std::vector<pid_t> children;
+        for (int r = 0; r < ranks; ++r) {
+            const pid_t pid = fork();
+            if (pid < 0) {
+                close_all();
+                for (pid_t child : children) waitpid(child, nullptr, 0);
+                throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+            }
+            if (pid == 0) {
+                for (int fd : all_fds) {
+                    if (fd != to_parent[r] && std::find(mesh[r].begin(), mesh[r].end(), fd) == mesh[r].end()) close(fd);
+                }
+                int status = 0;
+                try {
+                    Mesh rank_mesh{r, mesh[r]};
+                    RankOutput out = body(rank_mesh);
+                    out.report.bytes_sent = rank_mesh.bytes_sent;
+                    out.report.bytes_received = rank_mesh.bytes_received;
+                    send_output(to_parent[r], out);
+                }
+                catch (const std::exception& e) {
+                    try {
+                        send_error(to_parent[r], std::to_string(r) + ": " + e.what());
+                    }
+                    catch (...) {}
+                    status = 1;
+                }
+                // Skip the caller's atexit handlers and static destructors
+                _exit(status);
+            }
+            children.push_back(pid);
+        }
+        for (int r = 0; r < ranks; ++r) {
+            for (int fd : mesh[r]) {
+                if (fd >= 0) close(fd);
+            }
+            close(to_parent[r]);
+        }
+
+        std::string error;
+        if (stats) {
+            stats->ranks = ranks;
+            stats->compute_ms.assign(ranks, 0);
+            stats->comm_ms.assign(ranks, 0);
+            stats->bytes_sent.assign(ranks, 0);
+            stats->bytes_received.assign(ranks, 0);
+        }
+        for (int r = 0; r < ranks && error.empty(); ++r) {
+            try {
+                int ok = 0;
+                read_all(to_child[r], &ok, sizeof(ok));
+                if (!ok) {
+                    int length = 0;
+                    read_all(to_child[r], &length, sizeof(length));
+                    error.resize(length);
+                    read_all(to_child[r], error.data(), length);
+                    error = "Distributed rank " + error;
+                    break;
+                }
+                RankReport report;
+                int header[5];
+                read_all(to_child[r], &report, sizeof(report));
+                read_all(to_child[r], header, sizeof(header));
+                if (header[0]) {
+                    const int row0 = header[1], col0 = header[2], rows = header[3], cols = header[4];
+                    for (int i = 0; i < rows; ++i) {
+                        read_all(to_child[r], C.data() + (row0 + i) * C.row_stride() + col0, sizeof(int) * cols);
+                    }
+                }
+                if (stats) {
+                    stats->compute_ms[r] = report.compute_ms;
+                    stats->comm_ms[r] = report.comm_ms;
+                    stats->bytes_sent[r] = report.bytes_sent;
+                    stats->bytes_received[r] = report.bytes_received;
+                }
+            }
+            catch (const std::exception& e) {
+                error = std::string("Distributed rank ") + std::to_string(r) + " failed: " + e.what();
+            }
+        }
+        for (int r = 0; r < ranks; ++r) close(to_child[r]);
+        for (pid_t child : children) waitpid(child, nullptr, 0);
+        if (!error.empty()) throw std::runtime_error(error);
+        if (stats) stats->wall_ms = elapsed_ms(start);
+    }
+
+    // c += a * b inside a rank. GNU libgomp cannot start a multi-threaded team in a
+    // child forked from a process that already ran one, so ranks split the rows into
+    // bands over std::threads, each making a single-threaded matmul_blocked call.
+    static void local_multiply_add(const Matrix& a, const Matrix& b, Matrix& c, int block_size, int threads) {
+        const int rows = c.get_rows();
+        const int cols = c.get_cols();
+        threads = std::clamp(threads, 1, rows);
+        auto band = [&](int t) {
+            const int r0 = offset(rows, threads, t), r1 = offset(rows, threads, t + 1);
+            if (r0 == r1) return;
+            const Matrix a_band = block_of(a, r0, r1, 0, a.get_cols());
+            const Matrix product = matmul_blocked(a_band, b, block_size, 1);
+            for (int i = r0; i < r1; ++i) {
+                int* out = c.data() + i * c.row_stride();
+                const int* p = product.data() + (i - r0) * product.row_stride();
+                for (int j = 0; j < cols; ++j) out[j] += p[j];
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t) workers.emplace_back(band, t);
+        band(0);
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    // One rank of a g x g SUMMA grid running steps [s_begin, s_end). rank_of maps grid
+    // coordinates to mesh ranks; C_local accumulates the rank's block of C.
+    static void summa_steps(Mesh& mesh, int g, int gi, int gj, int s_begin, int s_end,
+                            const std::function<int(int, int)>& rank_of,
+                            const Matrix& A_local, const Matrix& B_local, Matrix& C_local,
+                            int depth, int block_size, int threads, RankReport& report) {
+        const int rows = C_local.get_rows();
+        const int cols = C_local.get_cols();
+        Matrix a_buf(1, 1, false), b_buf(1, 1, false);
+
+        for (int s = s_begin; s < s_end; ++s) {
+            const int depth_s = offset(depth, g, s + 1) - offset(depth, g, s);
+            const Matrix* a_panel = &A_local;
+            const Matrix* b_panel = &B_local;
+
+            Clock::time_point t = Clock::now();
+            std::exception_ptr send_error;
+            std::thread sender([&] {
+                try {
+                    if (gj == s) {
+                        for (int j = 0; j < g; ++j) if (j != gj) mesh.send(rank_of(gi, j), A_local);
+                    }
+                    if (gi == s) {
+                        for (int i = 0; i < g; ++i) if (i != gi) mesh.send(rank_of(i, gj), B_local);
+                    }
+                }
+                catch (...) {
+                    send_error = std::current_exception();
+                }
+            });
+            try {
+                if (gj != s) {
+                    a_buf.resize(rows, depth_s);
+                    mesh.recv(rank_of(gi, s), a_buf);
+                    a_panel = &a_buf;
+                }
+                if (gi != s) {
+                    b_buf.resize(depth_s, cols);
+                    mesh.recv(rank_of(s, gj), b_buf);
+                    b_panel = &b_buf;
+                }
+            }
+            catch (...) {
+                sender.join();
+                throw;
+            }
+            sender.join();
+            if (send_error) std::rethrow_exception(send_error);
+            report.comm_ms += elapsed_ms(t);
+
+            t = Clock::now();
+            local_multiply_add(*a_panel, *b_panel, C_local, block_size, threads);
+            report.compute_ms += elapsed_ms(t);
+        }
+    }
+
+    // g x g x c ranks numbered layer-major. Layer 0 starts with the blocks of A and B
+    // and replicates them to the other layers; layer l runs SUMMA steps
+    // [l*g/c, (l+1)*g/c); the partial C blocks are then summed back onto layer 0.
+    static Matrix multiply_25d(const Matrix& A, const Matrix& B, int g, int c, int block_size,
+                               int threads_per_rank, DistributedStats* stats) {
+        const int m = A.get_rows();
+        const int n = B.get_cols();
+        const int depth = A.get_cols();
+        if (std::min({m, n, depth}) < g) {
+            throw std::invalid_argument("Every dimension must be at least the grid size");
+        }
+        const int layer_size = g * g;
+        const int ranks = layer_size * c;
+
+        // Ranks talk within their layer's grid row and column, and to the ranks that
+        // hold the same block on other layers
+        auto connected = [g, layer_size](int a, int b) {
+            const int la = a / layer_size, lb = b / layer_size;
+            const int pa = a % layer_size, pb = b % layer_size;
+            if (la != lb) return pa == pb;
+            return pa / g == pb / g || pa % g == pb % g;
+        };
+        Matrix C(m, n);
+        run_ranks(ranks, connected, [&](Mesh& mesh) {
+            const int layer = mesh.rank / layer_size;
+            const int gi = mesh.rank % layer_size / g;
+            const int gj = mesh.rank % g;
+            auto rank_of = [&](int i, int j) { return layer * layer_size + i * g + j; };
+            const int r0 = offset(m, g, gi), r1 = offset(m, g, gi + 1);
+            const int c0 = offset(n, g, gj), c1 = offset(n, g, gj + 1);
+            const int k0 = offset(depth, g, gj), k1 = offset(depth, g, gj + 1);
+            const int kb0 = offset(depth, g, gi), kb1 = offset(depth, g, gi + 1);
+
+            RankOutput out;
+            Matrix A_local(r1 - r0, k1 - k0, false), B_local(kb1 - kb0, c1 - c0, false);
+            Clock::time_point t = Clock::now();
+            if (layer == 0) {
+                A_local = block_of(A, r0, r1, k0, k1);
+                B_local = block_of(B, kb0, kb1, c0, c1);
+                // Receivers on other layers do nothing else yet, so plain sends cannot block
+                for (int l = 1; l < c; ++l) {
+                    mesh.send(l * layer_size + gi * g + gj, A_local);
+                    mesh.send(l * layer_size + gi * g + gj, B_local);
+                }
+            } else {
+                mesh.recv(gi * g + gj, A_local);
+                mesh.recv(gi * g + gj, B_local);
+            }
+            out.report.comm_ms += elapsed_ms(t);
+
+            Matrix C_local(r1 - r0, c1 - c0, false);
+            summa_steps(mesh, g, gi, gj, layer * g / c, (layer + 1) * g / c, rank_of,
+                        A_local, B_local, C_local, depth, block_size, threads_per_rank, out.report);
+
+            t = Clock::now();
+            if (layer == 0) {
+                Matrix partial(r1 - r0, c1 - c0, false);
+                for (int l = 1; l < c; ++l) {
+                    mesh.recv(l * layer_size + gi * g + gj, partial);
+                    for (int i = 0; i < partial.get_rows(); ++i) {
+                        int* dst = C_local.data() + i * C_local.row_stride();
+                        const int* src = partial.data() + i * partial.row_stride();
+                        for (int j = 0; j < partial.get_cols(); ++j) dst[j] += src[j];
+                    }
+                }
+                out.has_block = true;
+                out.row0 = r0;
+                out.col0 = c0;
+                out.block = std::move(C_local);
+            } else {
+                mesh.send(gi * g + gj, C_local);
+            }
+            out.report.comm_ms += elapsed_ms(t);
+            return out;
+        }, C, stats);
+        return C;
+    }
+
+    static void check_operands(const Matrix& A, const Matrix& B, const char* engine) {
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument(std::string(engine) + " does not support transposed operands");
+        }
+    }
+
+    Matrix matmul_summa(const Matrix& A, const Matrix& B, int ranks, int block_size,
+                        int threads_per_rank, DistributedStats* stats) {
+        check_operands(A, B, "matmul_summa");
+        const int g = static_cast<int>(std::lround(std::sqrt(ranks)));
+        if (ranks < 1 || g * g != ranks) {
+            throw std::invalid_argument("SUMMA needs a square number of ranks");
+        }
+        return multiply_25d(A, B, g, 1, block_size, threads_per_rank, stats);
+    }
+
+    Matrix matmul_25d(const Matrix& A, const Matrix& B, int grid, int replication, int block_size,
+                      int threads_per_rank, DistributedStats* stats) {
+        check_operands(A, B, "matmul_25d");
+        if (grid < 1 || replication < 1 || grid % replication != 0) {
+            throw std::invalid_argument("2.5D needs a replication factor that divides the grid size");
+        }
+        return multiply_25d(A, B, grid, replication, block_size, threads_per_rank, stats);
+    }
+    #else
+    Matrix matmul_summa(const Matrix&, const Matrix&, int, int, int, DistributedStats*) {
+        throw std::runtime_error("Distributed multiplication needs POSIX processes and sockets");
+    }
+
+    Matrix matmul_25d(const Matrix&, const Matrix&, int, int, int, int, DistributedStats*) {
+        throw std::runtime_error("Distributed multiplication needs POSIX processes and sockets");
+    }
+    #endif
+}
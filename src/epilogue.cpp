@@ -0,0 +1,103 @@
+#include "../includes/epilogue.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace matmul {
+    // round(value * multiplier / 2^shift), half away from zero
+    static int64_t scale_rounded(int value, int multiplier, int shift) {
+        int64_t product = static_cast<int64_t>(value) * multiplier;
+        if (shift <= 0) return product;
+        const int64_t half = int64_t(1) << (shift - 1);
+        return product >= 0 ? (product + half) >> shift : -((-product + half) >> shift);
+    }
+
+    static int saturate_int32(int64_t value) {
+        return static_cast<int>(std::clamp<int64_t>(value, INT32_MIN, INT32_MAX));
+    }
+
+    Epilogue& Epilogue::bias_rows(std::vector<int> bias) {
+        m_ops.push_back({Kind::RowBias, std::move(bias), 0, 0});
+        return *this;
+    }
+
+    Epilogue& Epilogue::bias_cols(std::vector<int> bias) {
+        m_ops.push_back({Kind::ColBias, std::move(bias), 0, 0});
+        return *this;
+    }
+
+    static void validate_shift(int shift) {
+        if (shift < 0 || shift > 62) {
+            throw std::invalid_argument("Scale shift must be in [0, 62]");
+        }
+    }
+
+    Epilogue& Epilogue::scale(int multiplier, int shift) {
+        validate_shift(shift);
+        m_ops.push_back({Kind::Scale, {}, multiplier, shift});
+        return *this;
+    }
+
+    Epilogue& Epilogue::clamp(int lo, int hi) {
+        if (lo > hi) {
+            throw std::invalid_argument("Clamp bounds are reversed");
+        }
+        m_ops.push_back({Kind::Clamp, {}, lo, hi});
+        return *this;
+    }
+
+    Epilogue& Epilogue::relu() {
+        m_ops.push_back({Kind::Relu, {}, 0, 0});
+        return *this;
+    }
+
+    bool Epilogue::empty() const {
+        return m_ops.empty();
+    }
+
+    void Epilogue::validate(int rows, int cols) const {
+        for (const auto& op : m_ops) {
+            if ((op.kind == Kind::RowBias && op.bias.size() != static_cast<size_t>(rows)) ||
+                (op.kind == Kind::ColBias && op.bias.size() != static_cast<size_t>(cols))) {
+                throw std::invalid_argument("Epilogue bias size does not match the result");
+            }
+        }
+    }
+
+    void Epilogue::apply(int* tile, size_t ld, int row0, int col0, int rows, int cols) const {
+        for (const auto& op : m_ops) {
+            for (int i = 0; i < rows; ++i) {
+                int* row = tile + i * ld;
+                switch (op.kind) {
+                    case Kind::RowBias: {
+                        const int bias = op.bias[row0 + i];
+                        for (int j = 0; j < cols; ++j) row[j] += bias;
+                        break;
+                    }
+                    case Kind::ColBias: {
+                        const int* bias = op.bias.data() + col0;
+                        for (int j = 0; j < cols; ++j) row[j] += bias[j];
+                        break;
+                    }
+                    case Kind::Scale:
+                        for (int j = 0; j < cols; ++j) row[j] = saturate_int32(scale_rounded(row[j], op.a, op.b));
+                        break;
+                    case Kind::Clamp:
+                        for (int j = 0; j < cols; ++j) row[j] = std::clamp(row[j], op.a, op.b);
+                        break;
+                    case Kind::Relu:
+                        for (int j = 0; j < cols; ++j) row[j] = std::max(row[j], 0);
+                        break;
+                }
+            }
+        }
+    }
+
+    void Requantize::validate() const {
+        validate_shift(shift);
+    }
+
+    int8_t Requantize::operator()(int value) const {
+        int64_t q = scale_rounded(value, multiplier, shift) + zero_point;
+        return static_cast<int8_t>(std::clamp<int64_t>(q, INT8_MIN, INT8_MAX));
+    }
+}
@@ -0,0 +1,73 @@
+#include "../includes/executor.hpp"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+namespace matmul {
+    // About one L2-resident 256^3 block product per core; smaller jobs run on one core
+    static constexpr double FLOPS_PER_CORE = 2.0 * 256 * 256 * 256;
+
+    static int cores_for(const Matrix& A, const Matrix& B, int total_cores) {
+        const double flops = 2.0 * A.get_rows() * A.get_cols() * B.get_cols();
+        return static_cast<int>(std::clamp(flops / FLOPS_PER_CORE, 1.0, static_cast<double>(total_cores)));
+    }
+
+    Executor::Executor(int block_size, ComputeScheduler& scheduler)
+        : m_scheduler(scheduler), m_block_size(block_size) {
+        // At most one running job per core
+        for (int i = 0; i < scheduler.total_cores(); ++i) {
+            m_workers.emplace_back(&Executor::worker_loop, this);
+        }
+    }
+
+    Executor::~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_ready.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+    }
+
+    int Executor::total_cores() const {
+        return m_scheduler.total_cores();
+    }
+
+    std::future<Matrix> Executor::submit(Matrix A, Matrix B, Priority priority, LatencyClass latency) {
+        if (A.get_cols() != (B.layout() == Layout::Transposed ? B.get_cols() : B.get_rows())) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int cores = cores_for(A, B, m_scheduler.total_cores());
+        std::future<Matrix> result;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back({std::move(A), std::move(B), cores, priority, latency, {}});
+            result = m_queue.back().result.get_future();
+        }
+        m_ready.notify_one();
+        return result;
+    }
+
+    void Executor::worker_loop() {
+        while (true) {
+            std::optional<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_ready.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty()) return;
+                // First job of the highest priority
+                auto next = std::max_element(m_queue.begin(), m_queue.end(),
+                                             [](const Job& x, const Job& y) { return x.priority < y.priority; });
+                job.emplace(std::move(*next));
+                m_queue.erase(next);
+            }
+            try {
+                CoreLease lease = m_scheduler.acquire(job->cores, job->priority, job->latency);
+                job->result.set_value(lease.multiply(job->A, job->B, m_block_size, job->cores));
+            }
+            catch (...) {
+                job->result.set_exception(std::current_exception());
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "../includes/expr.hpp"
+#include "../includes/auto.hpp"
+#include "../includes/dispatch.hpp"
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    int expr::default_block_size() {
+        static const int block_size = block_size_for(get_cache_info());
+        return block_size;
+    }
+
+    void evaluate_fused(const std::vector<ProductTerm>& products, const std::vector<MatrixTerm>& addends,
+                        Matrix& C, int block_size, int num_threads) {
+        const int m = C.get_rows();
+        const int n = C.get_cols();
+        int depth = 1;
+        for (const auto& term : products) {
+            if (term.B->layout() != Layout::RowMajor) {
+                throw std::invalid_argument("Matrix expressions do not support transposed operands");
+            }
+            if (term.A->get_rows() != m || term.B->get_cols() != n || term.A->get_cols() != term.B->get_rows()) {
+                throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+            }
+            depth = std::max(depth, term.A->get_cols());
+        }
+        for (const auto& term : addends) {
+            if (term.M->layout() != Layout::RowMajor) {
+                throw std::invalid_argument("Matrix expressions do not support transposed operands");
+            }
+            if (term.M->get_rows() != m || term.M->get_cols() != n) {
+                throw std::invalid_argument("Matrix dimensions do not match for addition");
+            }
+        }
+        normalize_blocking(m, n, depth, block_size, num_threads);
+
+        const KernelTable& kernel = kernels();
+        int* c = C.data();
+        const size_t ldc = C.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(num_threads)
+        #endif
+        {
+            // Scaled products are accumulated here first, then folded into C
+            std::vector<int> scratch(static_cast<size_t>(block_size) * block_size);
+
+            #ifdef _OPENMP
+            #pragma omp for collapse(2) schedule(dynamic)
+            #endif
+            for (int i = 0; i < m; i += block_size) {
+                for (int j = 0; j < n; j += block_size) {
+                    const int rows = std::min(block_size, m - i);
+                    const int cols = std::min(block_size, n - j);
+                    int* c_tile = c + i * ldc + j;
+                    for (int ii = 0; ii < rows; ++ii) {
+                        std::fill(c_tile + ii * ldc, c_tile + ii * ldc + cols, 0);
+                    }
+
+                    for (const auto& term : products) {
+                        if (term.scale == 0) continue;
+                        const int k_total = term.A->get_cols();
+                        const size_t lda = term.A->row_stride();
+                        const size_t ldb = term.B->row_stride();
+                        const int* a = term.A->data() + i * lda;
+                        const int* b = term.B->data() + j;
+
+                        int* target = c_tile;
+                        size_t ld_target = ldc;
+                        if (term.scale != 1) {
+                            std::fill(scratch.begin(), scratch.end(), 0);
+                            target = scratch.data();
+                            ld_target = block_size;
+                        }
+                        for (int k = 0; k < k_total; k += block_size) {
+                            kernel.blocked_tile(a + k, lda, b + k * ldb, ldb, target, ld_target,
+                                                rows, std::min(block_size, k_total - k), cols);
+                        }
+                        if (term.scale != 1) {
+                            for (int ii = 0; ii < rows; ++ii) {
+                                kernel.axpy(c_tile + ii * ldc, scratch.data() + ii * block_size, term.scale, cols);
+                            }
+                        }
+                    }
+
+                    // Epilogue: additive terms while the tile is hot
+                    for (const auto& term : addends) {
+                        if (term.scale == 0) continue;
+                        const size_t ldm = term.M->row_stride();
+                        const int* m_tile = term.M->data() + i * ldm + j;
+                        for (int ii = 0; ii < rows; ++ii) {
+                            kernel.axpy(c_tile + ii * ldc, m_tile + ii * ldm, term.scale, cols);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
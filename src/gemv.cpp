@@ -0,0 +1,152 @@
+#include "../includes/gemv.hpp"
+#include "../includes/dispatch.hpp"
+#include "../includes/transpose.hpp"
+#include <algorithm>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    // 8 KiB of an A row: together with up to SKINNY_MAX_COLS slices of B^T it stays in L2
+    static constexpr int DEPTH_SLICE = 2048;
+    // Columns of y swept per gevm pass; 4 KiB of y stays in L1 across a thread's rows
+    static constexpr int GEVM_PANEL = 1024;
+
+    // y[i] = sum_k a(i, k) * x[k]
+    static void gemv_rows(const int* a, size_t lda, int rows, int depth, const int* x,
+                          int* y, int num_threads) {
+        const DotKernel dot = kernels().dot;
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(num_threads)
+        #endif
+        for (int i = 0; i < rows; ++i) {
+            y[i] = dot(a + i * lda, x, depth);
+        }
+        (void)num_threads;
+    }
+
+    // y[j] = sum_i x[i] * a(i, j). Rows of A are split across the team; every thread but
+    // the first accumulates into its own partial y, and the partials are summed by column.
+    static void gevm_cols(const int* x, const int* a, size_t lda, int rows, int cols,
+                          int* y, int num_threads) {
+        const AxpyKernel axpy = kernels().axpy;
+        std::fill(y, y + cols, 0);
+        std::vector<int> partial;
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(num_threads)
+        #endif
+        {
+            #ifdef _OPENMP
+            const int tid = omp_get_thread_num();
+            const int team = omp_get_num_threads();
+            #else
+            const int tid = 0;
+            const int team = 1;
+            #endif
+            #ifdef _OPENMP
+            #pragma omp single
+            #endif
+            partial.assign(static_cast<size_t>(team - 1) * cols, 0);
+
+            int* acc = tid == 0 ? y : partial.data() + static_cast<size_t>(tid - 1) * cols;
+            const int first = static_cast<int>(static_cast<long>(rows) * tid / team);
+            const int last = static_cast<int>(static_cast<long>(rows) * (tid + 1) / team);
+            for (int j0 = 0; j0 < cols; j0 += GEVM_PANEL) {
+                const int width = std::min(GEVM_PANEL, cols - j0);
+                for (int i = first; i < last; ++i) {
+                    if (x[i] != 0) {
+                        axpy(acc + j0, a + i * lda + j0, x[i], width);
+                    }
+                }
+            }
+
+            if (team > 1) {
+                #ifdef _OPENMP
+                #pragma omp barrier
+                #pragma omp for schedule(static)
+                #endif
+                for (int j0 = 0; j0 < cols; j0 += GEVM_PANEL) {
+                    const int j_max = std::min(j0 + GEVM_PANEL, cols);
+                    for (int t = 0; t < team - 1; ++t) {
+                        const int* src = partial.data() + static_cast<size_t>(t) * cols;
+                        for (int j = j0; j < j_max; ++j) y[j] += src[j];
+                    }
+                }
+            }
+        }
+        (void)num_threads;
+    }
+
+    std::vector<int> gemv(const Matrix& A, const std::vector<int>& x, int num_threads) {
+        if (static_cast<int>(x.size()) != A.get_cols()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        std::vector<int> y(A.get_rows());
+        gemv_rows(A.data(), A.row_stride(), A.get_rows(), A.get_cols(), x.data(), y.data(),
+                  std::max(num_threads, 1));
+        return y;
+    }
+
+    std::vector<int> gevm(const std::vector<int>& x, const Matrix& A, int num_threads) {
+        if (static_cast<int>(x.size()) != A.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        std::vector<int> y(A.get_cols());
+        gevm_cols(x.data(), A.data(), A.row_stride(), A.get_rows(), A.get_cols(), y.data(),
+                  std::max(num_threads, 1));
+        return y;
+    }
+
+    Matrix matmul_skinny(const Matrix& A, const Matrix& B, int num_threads) {
+        const bool bt = B.layout() == Layout::Transposed;
+        const int m = A.get_rows();
+        const int depth = A.get_cols();
+        const int n = bt ? B.get_rows() : B.get_cols();
+        if (depth != (bt ? B.get_cols() : B.get_rows())) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        Matrix C(m, n);
+        num_threads = std::max(num_threads, 1);
+
+        // One pass over A: row-major views of the two degenerate shapes
+        if (m == 1 && !bt) {
+            gevm_cols(A.data(), B.data(), B.row_stride(), depth, n, C.data(), num_threads);
+            return C;
+        }
+        if (m == 1) {
+            gemv_rows(B.data(), B.row_stride(), n, depth, A.data(), C.data(), num_threads);
+            return C;
+        }
+
+        // B is small (n x depth once transposed), so copying it costs far less than
+        // the pass over A and lets every column be a unit-stride dot product
+        const Matrix transposed = bt ? Matrix(1, 1) : transpose(B, num_threads);
+        const Matrix& Bt = bt ? B : transposed;
+        const int* a = A.data();
+        const int* b = Bt.data();
+        int* c = C.data();
+        const size_t lda = A.row_stride();
+        const size_t ldb = Bt.row_stride();
+        const size_t ldc = C.row_stride();
+        const DotKernel dot = kernels().dot;
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(num_threads)
+        #endif
+        for (int i = 0; i < m; ++i) {
+            const int* a_row = a + i * lda;
+            int* c_row = c + i * ldc;
+            for (int k = 0; k < depth; k += DEPTH_SLICE) {
+                const int len = std::min(DEPTH_SLICE, depth - k);
+                for (int j = 0; j < n; ++j) {
+                    c_row[j] += dot(a_row + k, b + j * ldb + k, len);
+                }
+            }
+        }
+        (void)num_threads;
+        return C;
+    }
+}
@@ -1,9 +1,29 @@
+#include <algorithm>
+#include <chrono>
 #include <format>
 #include <string>
 #include <utility>
 #include <thread>
 #include "../includes/matrix.hpp"
 #include "../includes/cache_info.h"
+#include "../includes/cache_sim.hpp"
+#include "../includes/verify.hpp"
+#include "../includes/bench.hpp"
+#include "../includes/dispatch.hpp"
+#include "../includes/sparse.hpp"
+#include "../includes/chain.hpp"
+#include "../includes/expr.hpp"
+#include "../includes/transpose.hpp"
+#include "../includes/distributed.hpp"
+#include "../includes/auto.hpp"
+#include "../includes/epilogue.hpp"
+#include "../includes/syrk.hpp"
+#include "../includes/structured.hpp"
+#include "../includes/power.hpp"
+#include "../includes/executor.hpp"
+#include "../includes/scheduler.hpp"
+#include "../includes/packed.hpp"
+#include "../includes/streaming.hpp"
 #include "../includes/kaizen.h"
 
 // #define NOMINMAX
@@ -12,31 +32,940 @@ std::pair<int, int> parse_args(int argc, char** argv) {
     zen::cmd_args args(argv, argc);
     int size = 1024;
     int num_threads = std::thread::hardware_concurrency();
-    if (!args.is_present("--size")|| !args.is_present("--threads")) {
+    auto size_options = args.get_options("--size");
+    auto thread_options = args.get_options("--threads");
+    if (size_options.empty() && thread_options.empty()) {
         zen::log(zen::color::yellow("No --size or --threads provided. Using default values: "));
-        return {size, num_threads};
-    } else {
-        size = std::stoi(args.get_options("--size")[0]);
-        num_threads = std::stoi(args.get_options("--threads")[0]);
     }
+    if (!size_options.empty()) size = std::stoi(size_options[0]);
+    if (!thread_options.empty()) num_threads = std::stoi(thread_options[0]);
     return {size, num_threads};
 }
 
+// --simulate [L1 [L2 [L3]]]: sizes in bytes override the ones reported by CacheInfo
+std::vector<matmul::CacheLevelConfig> simulated_levels(const zen::cmd_args& args, const CacheInfo& info) {
+    auto levels = matmul::cache_levels_from(info);
+    auto sizes = args.get_options("--simulate");
+    const char* names[] = {"L1D", "L2", "L3"};
+    const size_t ways[] = {8, 16, 16};
+    for (size_t i = 0; i < sizes.size() && i < 3; ++i) {
+        matmul::CacheLevelConfig level = {names[i], std::stoul(sizes[i]),
+                                          info.line_size > 0 ? static_cast<size_t>(info.line_size) : matmul::CACHE_LINE_SIZE,
+                                          ways[i]};
+        if (i < levels.size()) levels[i] = level;
+        else levels.push_back(level);
+    }
+    if (!sizes.empty() && levels.size() > sizes.size()) levels.resize(sizes.size());
+    return levels;
+}
+
+void run_cache_simulation(const std::vector<matmul::CacheLevelConfig>& levels,
+                          const matmul::Matrix& A, const matmul::Matrix& B, int blockSize) {
+    zen::log(std::format("Simulated Cache Misses (size = {}x{}):", A.get_rows(), A.get_cols()));
+    for (const auto& level : levels) {
+        zen::log(std::format("{}: {} bytes, {}-way, {} byte lines", level.name, level.size_bytes,
+                             level.associativity, level.line_size));
+    }
+    zen::log("----------------------------------------");
+    auto report = [](const std::string& method, const std::vector<matmul::CacheLevelStats>& stats) {
+        std::string line = std::format("{:<25}", method);
+        for (const auto& level : stats) {
+            line += std::format("{} misses: {:<14}", level.name, level.misses);
+        }
+        zen::log(line);
+    };
+    report("Naive", matmul::simulate_naive(A, B, levels));
+    report("Blocked (blockSize=" + std::to_string(blockSize) + ")", matmul::simulate_blocked(A, B, blockSize, levels));
+    report("Recursive", matmul::simulate_recursive(A, B, levels));
+    zen::log("----------------------------------------");
+}
+
+std::vector<int> int_options(const zen::cmd_args& args, const std::string& name, std::vector<int> defaults) {
+    auto options = args.get_options(name);
+    if (options.empty()) return defaults;
+    std::vector<int> values;
+    for (const auto& option : options) values.push_back(std::stoi(option));
+    return values;
+}
+
+// --shapes MxKxN ...
+std::vector<matmul::Shape> shape_options(const zen::cmd_args& args) {
+    std::vector<matmul::Shape> shapes;
+    for (const auto& option : args.get_options("--shapes")) {
+        matmul::Shape shape{};
+        if (std::sscanf(option.c_str(), "%dx%dx%d", &shape.m, &shape.k, &shape.n) != 3) {
+            throw std::invalid_argument("Shape must be MxKxN: " + option);
+        }
+        shapes.push_back(shape);
+    }
+    return shapes;
+}
+
+// --sweep [--sizes N ...] [--shapes MxKxN ...] [--thread-list T ...] [--repeats R]
+void run_sweep_mode(const zen::cmd_args& args, int blockSize) {
+    const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> default_threads;
+    for (int t = 1; t <= max_threads; t *= 2) default_threads.push_back(t);
+    if (default_threads.back() != max_threads) default_threads.push_back(max_threads);
+
+    matmul::SweepConfig config;
+    for (int n : int_options(args, "--sizes", {256, 512, 1000, 1023, 1024, 1025})) {
+        config.shapes.push_back({n, n, n});
+    }
+    for (const auto& shape : shape_options(args)) config.shapes.push_back(shape);
+    config.thread_counts = int_options(args, "--thread-list", default_threads);
+    config.algorithms = {matmul::Algorithm::Naive, matmul::Algorithm::Blocked, matmul::Algorithm::Recursive};
+    config.block_size = blockSize;
+    config.repeats = int_options(args, "--repeats", {3})[0];
+
+    auto sweep = matmul::run_sweep(config);
+
+    for (auto algorithm : config.algorithms) {
+        if (!matmul::is_parallel(algorithm)) continue;
+        zen::log(std::format("Strong Scaling: {} (median ms, parallel efficiency)", matmul::algorithm_name(algorithm)));
+        zen::log("----------------------------------------");
+        // Every cell, header and placeholder included, is right-aligned to this width
+        constexpr int cell_width = 20;
+        std::string header = std::format("{:<18}", "Shape");
+        for (int t : config.thread_counts) header += std::format("{:>{}}", "T=" + std::to_string(t), cell_width);
+        zen::log(header);
+        for (const auto& shape : config.shapes) {
+            const auto* base = matmul::find_result(sweep.strong, algorithm, shape, config.thread_counts.front());
+            if (!base) continue;
+            std::string line = std::format("{:<18}", matmul::shape_name(shape));
+            for (int t : config.thread_counts) {
+                const auto* r = matmul::find_result(sweep.strong, algorithm, shape, t);
+                if (!r) {
+                    line += std::format("{:>{}}", "-", cell_width);
+                    continue;
+                }
+                double ratio = static_cast<double>(t) / config.thread_counts.front();
+                double efficiency = base->median_ms() / (ratio * r->median_ms());
+                line += std::format("{:>{}}", std::format("{:.2f} ({:.2f})", r->median_ms(), efficiency), cell_width);
+            }
+            zen::log(line);
+        }
+        zen::log("----------------------------------------");
+
+        zen::log(std::format("Weak Scaling: {} (work per thread held constant)", matmul::algorithm_name(algorithm)));
+        zen::log("----------------------------------------");
+        zen::log(header);
+        for (const auto& shape : config.shapes) {
+            const auto* base = matmul::find_result(sweep.weak, algorithm, shape, config.thread_counts.front());
+            if (!base) continue;
+            std::string line = std::format("{:<18}", matmul::shape_name(shape));
+            for (int t : config.thread_counts) {
+                const auto* r = matmul::find_result(sweep.weak, algorithm, shape, t);
+                if (!r) {
+                    line += std::format("{:>{}}", "-", cell_width);
+                    continue;
+                }
+                line += std::format("{:>{}}", std::format("{:.2f} ({:.2f})", r->median_ms(), base->median_ms() / r->median_ms()),
+                                    cell_width);
+            }
+            zen::log(line);
+        }
+        zen::log("----------------------------------------");
+    }
+
+    // Fastest algorithm per shape, ordered by flops; a change of winner is a crossover
+    auto shapes = config.shapes;
+    std::stable_sort(shapes.begin(), shapes.end(), [](const matmul::Shape& a, const matmul::Shape& b) {
+        return matmul::flops(a) < matmul::flops(b);
+    });
+    for (int t : config.thread_counts) {
+        zen::log(std::format("Fastest Algorithm (threads = {}):", t));
+        zen::log("----------------------------------------");
+        std::string previous;
+        for (const auto& shape : shapes) {
+            const matmul::BenchResult* best = nullptr;
+            for (auto algorithm : config.algorithms) {
+                const auto* r = matmul::find_result(sweep.strong, algorithm, shape, t);
+                if (r && (!best || r->median_ms() < best->median_ms())) best = r;
+            }
+            if (!best) continue;
+            std::string winner = matmul::algorithm_name(best->bench_case.algorithm);
+            std::string mark = (!previous.empty() && winner != previous) ? "  <- crossover" : "";
+            zen::log(std::format("{:<18}{:<12}{:>12.2f} ms{}", matmul::shape_name(shape), winner, best->median_ms(), mark));
+            previous = winner;
+        }
+        zen::log("----------------------------------------");
+    }
+
+    auto baseline_path = args.get_options("--save-baseline");
+    if (!baseline_path.empty()) {
+        // Single-threaded algorithms were timed once; store them once
+        matmul::Baseline baseline{blockSize, {}};
+        for (const auto& result : sweep.strong) {
+            if (matmul::is_parallel(result.bench_case.algorithm) ||
+                result.bench_case.threads == config.thread_counts.front()) {
+                baseline.results.push_back(result);
+            }
+        }
+        matmul::save_baseline(baseline_path[0], baseline);
+        zen::log(std::format("Baseline with {} cases saved to {}", baseline.results.size(), baseline_path[0]));
+    }
+}
+
+// --save-baseline FILE [--repeats R]: times every algorithm at --size/--threads and stores the samples
+void save_baseline_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const int repeats = int_options(args, "--repeats", {5})[0];
+    matmul::Baseline baseline{blockSize, {}};
+    for (auto algorithm : {matmul::Algorithm::Naive, matmul::Algorithm::Blocked, matmul::Algorithm::Recursive}) {
+        auto result = matmul::run_benchmark({algorithm, {size, size, size}, num_threads}, blockSize, repeats);
+        zen::log(std::format("{:<25}{:>12.2f} ms", matmul::algorithm_name(algorithm), result.median_ms()));
+        baseline.results.push_back(result);
+    }
+    const auto path = args.get_options("--save-baseline")[0];
+    matmul::save_baseline(path, baseline);
+    zen::log(std::format("Baseline with {} cases saved to {}", baseline.results.size(), path));
+}
+
+// --compare FILE [--threshold PCT]: reruns the baseline configuration, returns true on regression
+bool compare_mode(const zen::cmd_args& args) {
+    auto threshold_options = args.get_options("--threshold");
+    const double threshold = threshold_options.empty() ? 5.0 : std::stod(threshold_options[0]);
+    const auto path = args.get_options("--compare")[0];
+
+    auto baseline = matmul::load_baseline(path);
+    auto current = matmul::rerun_baseline(baseline);
+    auto comparisons = matmul::compare_results(baseline.results, current, threshold);
+
+    zen::log(std::format("Regression Check against {} (threshold = {}%):", path, threshold));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<12}{:<18}{:>8}{:>14}{:>14}{:>10}{:>10}", "Method", "Shape", "Threads",
+                         "Baseline ms", "Current ms", "Delta", "p"));
+    bool regressed = false;
+    for (const auto& cmp : comparisons) {
+        std::string line = std::format("{:<12}{:<18}{:>8}{:>14.2f}{:>14.2f}{:>9.1f}%{:>10.3f}",
+                                       matmul::algorithm_name(cmp.bench_case.algorithm),
+                                       matmul::shape_name(cmp.bench_case.shape), cmp.bench_case.threads,
+                                       cmp.baseline_ms, cmp.current_ms, cmp.delta_pct, cmp.p_value);
+        if (cmp.regressed) {
+            zen::log(zen::color::red(line + "  REGRESSION"));
+            regressed = true;
+        } else {
+            zen::log(line);
+        }
+    }
+    zen::log("----------------------------------------");
+    return regressed;
+}
+
+// --sparse DENSITY: sparse A against the dense blocked engine
+void run_sparse_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    auto options = args.get_options("--sparse");
+    const double density = options.empty() ? 0.02 : std::stod(options[0]);
+    matmul::Matrix A = matmul::random_sparse(size, size, density);
+    matmul::Matrix B(size, size);
+    B.fill_matrix();
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix D = matmul::matmul_blocked(A, B, blockSize, num_threads);
+    t.stop();
+    auto time_dense = t.duration_string();
+
+    t.start();
+    matmul::CsrMatrix csr = matmul::CsrMatrix::from_dense(A);
+    t.stop();
+    auto time_convert = t.duration_string();
+
+    // Column blocks of B sized like the dense engine's tiles
+    const int block_cols = blockSize * 4;
+    t.start();
+    matmul::Matrix S = matmul::matmul_spmm(csr, B, block_cols, num_threads);
+    t.stop();
+    auto time_sparse = t.duration_string();
+
+    zen::log(std::format("Sparse x Dense Performance (size = {}x{}, density = {}, nnz = {}):",
+                         size, size, density, csr.nnz()));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Blocked (dense)", time_dense));
+    zen::log(std::format("{:<25}{}", "CSR conversion", time_convert));
+    zen::log(std::format("{:<25}{}", "CSR SpMM", time_sparse));
+    if (args.is_present("--verify")) {
+        zen::log(std::format("{:<25}", "CSR SpMM"),
+                 matmul::freivalds_verify(A, B, S, 10, num_threads) ? zen::color::green("PASS") : zen::color::red("FAIL"));
+    }
+    zen::log("----------------------------------------");
+}
+
+// --chain D0 D1 ... Dn: product of M_i (D_i x D_i+1), planned order against source order
+void run_chain_mode(const zen::cmd_args& args, int num_threads, int blockSize) {
+    std::vector<int> dims = int_options(args, "--chain", {});
+    if (dims.size() < 3) {
+        throw std::invalid_argument("--chain needs at least three dimensions");
+    }
+    std::vector<matmul::Matrix> matrices;
+    for (size_t i = 0; i + 1 < dims.size(); ++i) {
+        matrices.emplace_back(dims[i], dims[i + 1]);
+        matrices.back().fill_matrix();
+    }
+    auto plan = matmul::plan_chain(dims, num_threads);
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix in_order = matrices[0];
+    for (size_t i = 1; i < matrices.size(); ++i) {
+        in_order = matmul::matmul_blocked(in_order, matrices[i], blockSize, num_threads);
+    }
+    t.stop();
+    auto time_in_order = t.duration_string();
+
+    matmul::MatrixPool pool;
+    t.start();
+    matmul::Matrix planned = matmul::matmul_chain(matrices, blockSize, num_threads, &pool);
+    t.stop();
+
+    double in_order_flops = 0;
+    for (size_t i = 2; i < dims.size(); ++i) in_order_flops += 2.0 * dims[0] * dims[i - 1] * dims[i];
+
+    zen::log(std::format("Matrix Chain ({} matrices):", matrices.size()));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{:<12.4g}{}", "Source order", in_order_flops, time_in_order));
+    zen::log(std::format("{:<25}{:<12.4g}{}", "Planned", plan.flops, t.duration_string()));
+    zen::log(std::format("Plan: {}", plan.parenthesization));
+    zen::log(std::format("Buffers allocated: {}", pool.allocations()));
+    zen::log(std::format("Results match: {}", in_order.get_data() == planned.get_data()));
+    zen::log("----------------------------------------");
+}
+
+// --expr: D = 2*A*B - C evaluated lazily against matmul_blocked plus an elementwise pass
+void run_expr_mode(int size, int num_threads, int blockSize) {
+    matmul::Matrix A(size, size), B(size, size), C(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+    C.fill_matrix();
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix D = matmul::matmul_blocked(A, B, blockSize, num_threads);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            D.at(i, j) = 2 * D.at(i, j) - C.at(i, j);
+        }
+    }
+    t.stop();
+    auto time_separate = t.duration_string();
+
+    t.start();
+    matmul::Matrix F = matmul::evaluate(2 * A * B - C, blockSize, num_threads);
+    t.stop();
+
+    zen::log(std::format("Expression D = 2*A*B - C (size = {}x{}):", size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Blocked + elementwise", time_separate));
+    zen::log(std::format("{:<25}{}", "Fused expression", t.duration_string()));
+    zen::log(std::format("Results match: {}", D.get_data() == F.get_data()));
+    zen::log("----------------------------------------");
+}
+
+// --transpose: cache-oblivious transpose, and A*B against A*(B^T stored transposed)
+void run_transpose_mode(int size, int num_threads, int blockSize) {
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix Bt = matmul::transposed_operand(B, num_threads);
+    t.stop();
+    auto time_transpose = t.duration_string();
+
+    t.start();
+    matmul::Matrix C = matmul::matmul_blocked(A, B, blockSize, num_threads);
+    t.stop();
+    auto time_row_major = t.duration_string();
+
+    t.start();
+    matmul::Matrix Ct = matmul::matmul_blocked(A, Bt, blockSize, num_threads);
+    t.stop();
+
+    zen::log(std::format("Transposed operand (size = {}x{}):", size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Transpose B", time_transpose));
+    zen::log(std::format("{:<25}{}", "Blocked, B row-major", time_row_major));
+    zen::log(std::format("{:<25}{}", "Blocked, B transposed", t.duration_string()));
+    zen::log(std::format("Results match: {}", C.get_data() == Ct.get_data()));
+    zen::log("----------------------------------------");
+}
+
+// --summa RANKS [--replication C]: SUMMA (or 2.5D with C layers) over RANKS local
+// worker processes, threads split between them
+void run_summa_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    auto options = args.get_options("--summa");
+    const int ranks = options.empty() ? 4 : std::stoi(options[0]);
+    const std::vector<int> replication = int_options(args, "--replication", {1});
+    const int layers = std::max(1, replication[0]);
+    const int grid = static_cast<int>(std::lround(std::sqrt(ranks / layers)));
+    if (grid * grid * layers != ranks) {
+        throw std::invalid_argument("RANKS must be grid * grid * replication");
+    }
+    const int threads_per_rank = std::max(1, num_threads / ranks);
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+
+    matmul::DistributedStats stats;
+    matmul::Matrix C = matmul::matmul_25d(A, B, grid, layers, blockSize, threads_per_rank, &stats);
+    matmul::Matrix reference = matmul::matmul_blocked(A, B, blockSize, num_threads);
+
+    zen::log(std::format("{} (size = {}x{}, grid = {}x{}x{}, threads per rank = {}):",
+                         layers == 1 ? "SUMMA" : "2.5D", size, size, grid, grid, layers, threads_per_rank));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<8}{:<16}{:<12}{}", "Rank", "Compute (ms)", "Comm (ms)", "Sent (KiB)"));
+    for (int r = 0; r < stats.ranks; ++r) {
+        zen::log(std::format("{:<8}{:<16.2f}{:<12.2f}{:.1f}", r, stats.compute_ms[r], stats.comm_ms[r],
+                             stats.bytes_sent[r] / 1024.0));
+    }
+    zen::log(std::format("Wall time: {:.2f} ms", stats.wall_ms));
+    zen::log(std::format("Results match: {}", C.get_data() == reference.get_data()));
+    zen::log("----------------------------------------");
+}
+
+// --epilogue: blocked multiply with a fused bias/scale/ReLU epilogue and int8
+// requantization, against the plain multiply followed by the same operations
+void run_epilogue_mode(int size, int num_threads, int blockSize) {
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+    std::vector<int> bias(size);
+    for (int i = 0; i < size; ++i) bias[i] = i % 17 - 8;
+    matmul::Epilogue epilogue;
+    epilogue.bias_rows(bias).scale(3, 4).relu();
+    const matmul::Requantize requantize{5, 6, -3};
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix reference = matmul::matmul_blocked(A, B, blockSize, num_threads);
+    epilogue.apply(reference.data(), reference.row_stride(), 0, 0, size, size);
+    t.stop();
+    auto time_separate = t.duration_string();
+
+    t.start();
+    matmul::Matrix fused = matmul::matmul_blocked(A, B, blockSize, num_threads, epilogue);
+    t.stop();
+    auto time_fused = t.duration_string();
+
+    t.start();
+    matmul::Matrix8 Q = matmul::matmul_blocked_requantized(A, B, blockSize, num_threads, epilogue, requantize);
+    t.stop();
+    bool requantized_match = true;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            requantized_match = requantized_match && Q.at(i, j) == requantize(reference.at(i, j));
+        }
+    }
+
+    zen::log(std::format("Fused epilogue: bias, scale, ReLU (size = {}x{}):", size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Blocked + epilogue pass", time_separate));
+    zen::log(std::format("{:<25}{}", "Fused epilogue", time_fused));
+    zen::log(std::format("{:<25}{}", "Fused + requantize", t.duration_string()));
+    zen::log(std::format("Results match: {}", reference.get_data() == fused.get_data()));
+    zen::log(std::format("Requantized match: {}", requantized_match));
+    zen::log("----------------------------------------");
+}
+
+// --syrk: A*A^T (upper, mirrored) and A^T*A (lower, unmirrored) for a size x size/2
+// A, against matmul_blocked on an explicit transpose
+void run_syrk_mode(int size, int num_threads, int blockSize) {
+    const int depth = std::max(1, size / 2);
+    matmul::Matrix A(size, depth);
+    A.fill_matrix();
+    const matmul::Matrix At = matmul::transpose(A, num_threads);
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix AAt = matmul::matmul_blocked(A, At, blockSize, num_threads);
+    t.stop();
+    auto time_blocked = t.duration_string();
+
+    t.start();
+    matmul::Matrix G = matmul::syrk(A, matmul::Gram::AAt, matmul::Triangle::Upper, blockSize, num_threads);
+    t.stop();
+    auto time_syrk = t.duration_string();
+
+    // Unmirrored: the lower triangle must match and the strict upper one stay zero
+    matmul::Matrix AtA = matmul::matmul_blocked(At, A, blockSize, num_threads);
+    matmul::Matrix L = matmul::syrk(A, matmul::Gram::AtA, matmul::Triangle::Lower, blockSize, num_threads, false);
+    bool lower_match = true;
+    for (int i = 0; i < depth; ++i) {
+        for (int j = 0; j < depth; ++j) {
+            lower_match = lower_match && L.at(i, j) == (j <= i ? AtA.at(i, j) : 0);
+        }
+    }
+
+    zen::log(std::format("Gram matrix A*A^T (A = {}x{}):", size, depth));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Transpose + blocked", time_blocked));
+    zen::log(std::format("{:<25}{}", "syrk (upper, mirrored)", time_syrk));
+    zen::log(std::format("Results match: {}", AAt.get_data() == G.get_data()));
+    zen::log(std::format("A^T*A lower triangle match: {}", lower_match));
+    zen::log("----------------------------------------");
+}
+
+// --band [LOWER UPPER]: matmul_structured for upper-triangular, lower-triangular and
+// banded (default 16/16) A, against matmul_blocked on A with the out-of-band entries
+// zeroed; matmul_structured gets the unmasked A, so reading outside the band would show
+void run_band_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const std::vector<int> widths = int_options(args, "--band", {16, 16});
+    if (widths.size() != 2) {
+        throw std::invalid_argument("--band takes LOWER and UPPER bandwidths");
+    }
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+
+    zen::log(std::format("Structured operands (size = {}x{}):", size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{:<20}{:<20}{}", "Band", "Blocked (masked)", "Structured", "Match"));
+    const std::pair<std::string, matmul::Band> bands[] = {
+        {"Upper triangular", matmul::Band::upper_triangular()},
+        {"Lower triangular", matmul::Band::lower_triangular()},
+        {std::format("Banded {}/{}", widths[0], widths[1]), matmul::Band::banded(widths[0], widths[1])},
+    };
+    for (const auto& [name, band] : bands) {
+        matmul::Matrix masked(size, size);
+        for (int i = 0; i < size; ++i) {
+            for (int k = 0; k < size; ++k) {
+                const bool in_band = k >= i - static_cast<long>(band.lower) && k <= i + static_cast<long>(band.upper);
+                masked.at(i, k) = in_band ? A.at(i, k) : 0;
+            }
+        }
+        zen::timer t;
+        t.start();
+        matmul::Matrix reference = matmul::matmul_blocked(masked, B, blockSize, num_threads);
+        t.stop();
+        auto time_blocked = t.duration_string();
+        t.start();
+        matmul::Matrix C = matmul::matmul_structured(A, band, B, blockSize, num_threads);
+        t.stop();
+        zen::log(std::format("{:<25}{:<20}{:<20}{}", name, time_blocked, t.duration_string(),
+                             reference.get_data() == C.get_data()));
+    }
+    zen::log("----------------------------------------");
+}
+
+// --power [K] [--modulus M]: A^K by binary exponentiation (default K = 13), wrapping and
+// modulo M (default 1000003), against K - 1 sequential multiplies
+void run_power_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const std::vector<int> exponent = int_options(args, "--power", {13});
+    const std::vector<int> modulus_option = int_options(args, "--modulus", {1000003});
+    const int k = exponent[0];
+    const int modulus = modulus_option[0];
+    if (k < 1 || modulus < 1) {
+        throw std::invalid_argument("--power needs K >= 1 and --modulus M >= 1");
+    }
+    // The reference sums size products below M^2 in int64
+    if (static_cast<double>(size) * (modulus - 1.0) * (modulus - 1.0) >= 9.2e18) {
+        throw std::invalid_argument("--modulus too large for the int64 reference at this size");
+    }
+    matmul::Matrix A(size, size);
+    A.fill_matrix();
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix sequential = A;
+    for (int step = 1; step < k; ++step) {
+        sequential = matmul::matmul_blocked(sequential, A, blockSize, num_threads);
+    }
+    t.stop();
+    auto time_sequential = t.duration_string();
+
+    t.start();
+    matmul::Matrix P = matmul::matmul_power(A, k, blockSize, num_threads);
+    t.stop();
+    auto time_power = t.duration_string();
+
+    matmul::Matrix reduced(size, size), sequential_mod(size, size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) reduced.at(i, j) = sequential_mod.at(i, j) = A.at(i, j) % modulus;
+    }
+    for (int step = 1; step < k; ++step) {
+        matmul::Matrix64 wide = matmul::matmul_blocked_wide(sequential_mod, reduced, blockSize, num_threads);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) sequential_mod.at(i, j) = static_cast<int>(wide.at(i, j) % modulus);
+        }
+    }
+    t.start();
+    matmul::Matrix M = matmul::matmul_power_mod(A, k, modulus, blockSize, num_threads);
+    t.stop();
+
+    zen::log(std::format("Matrix power A^{} (size = {}x{}):", k, size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Sequential multiplies", time_sequential));
+    zen::log(std::format("{:<25}{}", "Binary exponentiation", time_power));
+    zen::log(std::format("{:<25}{}", "Modulo " + std::to_string(modulus), t.duration_string()));
+    zen::log(std::format("Results match: {}", sequential.get_data() == P.get_data()));
+    zen::log(std::format("Modular results match: {}", sequential_mod.get_data() == M.get_data()));
+    zen::log("----------------------------------------");
+}
+
+// --executor [JOBS]: JOBS products (default 8) of mixed sizes up to size, submitted
+// to an Executor with mixed priorities, against running them one after another
+void run_executor_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const int jobs = std::max(1, int_options(args, "--executor", {8})[0]);
+    std::vector<std::pair<matmul::Matrix, matmul::Matrix>> operands;
+    for (int job = 0; job < jobs; ++job) {
+        const int n = std::max(1, size >> (job % 4));
+        operands.emplace_back(matmul::Matrix(n, n), matmul::Matrix(n, n));
+        operands.back().first.fill_matrix();
+        operands.back().second.fill_matrix();
+    }
+
+    zen::timer t;
+    t.start();
+    for (const auto& [A, B] : operands) matmul::matmul_blocked(A, B, blockSize, num_threads);
+    t.stop();
+    auto time_sequential = t.duration_string();
+
+    matmul::Executor executor(blockSize);
+    std::vector<std::future<matmul::Matrix>> results;
+    const matmul::Priority priorities[] = {matmul::Priority::Low, matmul::Priority::Normal, matmul::Priority::High};
+    t.start();
+    for (int job = 0; job < jobs; ++job) {
+        results.push_back(executor.submit(operands[job].first, operands[job].second, priorities[job % 3]));
+    }
+    std::vector<matmul::Matrix> products;
+    for (auto& result : results) products.push_back(result.get());
+    t.stop();
+
+    int passed = 0;
+    for (int job = 0; job < jobs; ++job) {
+        passed += matmul::freivalds_verify(operands[job].first, operands[job].second, products[job], 10, num_threads);
+    }
+
+    zen::log(std::format("Executor ({} jobs, sizes {} down to {}, {} cores):", jobs, size,
+                         std::max(1, size >> std::min(jobs - 1, 3)), executor.total_cores()));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Sequential blocked", time_sequential));
+    zen::log(std::format("{:<25}{}", "Executor", t.duration_string()));
+    zen::log(std::format("Verified (Freivalds): {}/{}", passed, jobs));
+    zen::log("----------------------------------------");
+}
+
+// --scheduler [TENANTS]: TENANTS threads (default 4) each run matmul_scheduled with the
+// full thread budget on the shared scheduler, alternating interactive and batch jobs
+void run_scheduler_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const int tenants = std::max(1, int_options(args, "--scheduler", {4})[0]);
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+    auto& scheduler = matmul::ComputeScheduler::instance();
+
+    std::vector<matmul::Matrix> results(tenants, matmul::Matrix(1, 1));
+    std::vector<double> elapsed_ms(tenants);
+    std::vector<std::thread> threads;
+    zen::timer t;
+    t.start();
+    for (int tenant = 0; tenant < tenants; ++tenant) {
+        threads.emplace_back([&, tenant] {
+            const auto start = std::chrono::steady_clock::now();
+            const auto latency = tenant % 2 ? matmul::LatencyClass::Batch : matmul::LatencyClass::Interactive;
+            results[tenant] = matmul::matmul_scheduled(A, B, blockSize, num_threads, matmul::Priority::Normal, latency);
+            elapsed_ms[tenant] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    t.stop();
+
+    zen::log(std::format("Shared core budget ({} tenants, size = {}x{}, {} cores):", tenants, size, size,
+                         scheduler.total_cores()));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<8}{:<14}{:<12}{}", "Tenant", "Class", "Time (ms)", "Verified"));
+    for (int tenant = 0; tenant < tenants; ++tenant) {
+        const bool ok = matmul::freivalds_verify(A, B, results[tenant], 10, num_threads);
+        zen::log(std::format("{:<8}{:<14}{:<12.2f}{}", tenant, tenant % 2 ? "Batch" : "Interactive",
+                             elapsed_ms[tenant], ok));
+    }
+    zen::log(std::format("Wall time: {}", t.duration_string()));
+    zen::log(std::format("All cores returned: {}", scheduler.free_cores() == scheduler.total_cores()));
+    zen::log("----------------------------------------");
+}
+
+// --packed [CALLS]: CALLS multiplies (default 5) against one B through a PackCache, with
+// B changed and its version bumped halfway, against matmul_blocked on the current B
+void run_packed_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const int calls = std::max(2, int_options(args, "--packed", {5})[0]);
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+    matmul::PackCache cache(static_cast<size_t>(size) * size * sizeof(int) * 4);
+    uint64_t version = 0;
+
+    double blocked_ms = 0, packed_ms = 0;
+    bool match = true;
+    for (int call = 0; call < calls; ++call) {
+        if (call == calls / 2) {
+            B.fill_matrix();
+            ++version;
+        }
+        auto start = std::chrono::steady_clock::now();
+        matmul::Matrix reference = matmul::matmul_blocked(A, B, blockSize, num_threads);
+        blocked_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        auto packed = cache.get(B, version, blockSize);
+        matmul::Matrix C = matmul::matmul_blocked(A, *packed, num_threads);
+        packed_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        match = match && reference.get_data() == C.get_data();
+    }
+
+    // A transposed B packs to the same logical operand
+    const matmul::PackedMatrix from_transposed(matmul::transposed_operand(B, num_threads), blockSize);
+    const bool transposed_match = matmul::matmul_blocked(A, from_transposed, num_threads).get_data() ==
+                                  matmul::matmul_blocked(A, B, blockSize, num_threads).get_data();
+
+    zen::log(std::format("Prepacked B ({} calls, size = {}x{}):", calls, size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{:.2f} ms", "Blocked", blocked_ms));
+    zen::log(std::format("{:<25}{:.2f} ms", "PackCache + packed", packed_ms));
+    zen::log(std::format("Cache hits / misses: {} / {}", cache.hits(), cache.misses()));
+    zen::log(std::format("Results match: {}", match));
+    zen::log(std::format("Transposed B match: {}", transposed_match));
+    zen::log("----------------------------------------");
+}
+
+// --stream [ROWS]: A pushed in panels of ROWS rows (default 100) through StreamingMatmul,
+// C reassembled from the callbacks, against matmul_blocked on the whole A
+void run_stream_mode(const zen::cmd_args& args, int size, int num_threads, int blockSize) {
+    const int panel_rows = std::max(1, int_options(args, "--stream", {100})[0]);
+    matmul::Matrix A(size, size), B(size, size);
+    A.fill_matrix();
+    B.fill_matrix();
+
+    zen::timer t;
+    t.start();
+    matmul::Matrix reference = matmul::matmul_blocked(A, B, blockSize, num_threads);
+    t.stop();
+    auto time_blocked = t.duration_string();
+
+    matmul::Matrix C(size, size);
+    int next_row = 0;
+    bool in_order = true;
+    double first_panel_ms = 0;
+    const auto start = std::chrono::steady_clock::now();
+    t.start();
+    matmul::StreamingMatmul stream(B, [&](int first_row, matmul::Matrix panel) {
+        if (first_row == 0) {
+            first_panel_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        in_order = in_order && first_row == next_row;
+        next_row = first_row + panel.get_rows();
+        for (int i = 0; i < panel.get_rows(); ++i) {
+            for (int j = 0; j < size; ++j) C.at(first_row + i, j) = panel.at(i, j);
+        }
+    }, blockSize, num_threads);
+    for (int row = 0; row < size; row += panel_rows) {
+        const int rows = std::min(panel_rows, size - row);
+        matmul::Matrix panel(rows, size);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < size; ++j) panel.at(i, j) = A.at(row + i, j);
+        }
+        stream.push(std::move(panel));
+    }
+    stream.finish();
+    t.stop();
+
+    zen::log(std::format("Streaming row panels ({} rows each, size = {}x{}):", panel_rows, size, size));
+    zen::log("----------------------------------------");
+    zen::log(std::format("{:<25}{}", "Blocked (whole A)", time_blocked));
+    zen::log(std::format("{:<25}{}", "Streaming (all panels)", t.duration_string()));
+    zen::log(std::format("{:<25}{:.2f} ms", "First panel delivered", first_panel_ms));
+    zen::log(std::format("Rows pushed: {}, delivered in order: {}", stream.rows_pushed(), in_order && next_row == size));
+    zen::log(std::format("Results match: {}", reference.get_data() == C.get_data()));
+    zen::log("----------------------------------------");
+}
+
 int main(int argc, char** argv) {
     
+    zen::cmd_args args(argv, argc);
     auto [ size, num_threads ] = parse_args(argc, argv);
     // Compute blockSize from cache info
     CacheInfo info = get_cache_info();
-    int blockSize;
-    if (info.l1d_size > 0 && info.line_size > 0) {
-        int maxElements = info.l1d_size / sizeof(int);
-        blockSize = static_cast<int>(std::sqrt(maxElements / 3)); // For A, B, C
-        blockSize = (blockSize / (info.line_size / sizeof(int))) * (info.line_size / sizeof(int));
-        if (blockSize <= 0) blockSize = info.line_size / sizeof(int);
-    } else {
-        blockSize = 64; // 64 ints
+    int blockSize = matmul::block_size_for(info);
+    if (info.l1d_size <= 0 || info.line_size <= 0) {
         std::cerr << "Warning: Could not retrieve cache info, using blockSize = 64\n";
     }
+    // Kernel dispatch and the thread model's calibration, before any timed run
+    matmul::init();
+
+    if (args.is_present("--compare")) {
+        try {
+            return compare_mode(args) ? 1 : 0;
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 2;
+        }
+    }
+
+    if (args.is_present("--save-baseline") && !args.is_present("--sweep")) {
+        try {
+            save_baseline_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--sparse")) {
+        try {
+            run_sparse_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--expr")) {
+        try {
+            run_expr_mode(size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--summa")) {
+        try {
+            run_summa_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--transpose")) {
+        try {
+            run_transpose_mode(size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--chain")) {
+        try {
+            run_chain_mode(args, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--epilogue")) {
+        try {
+            run_epilogue_mode(size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--syrk")) {
+        try {
+            run_syrk_mode(size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--band")) {
+        try {
+            run_band_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--power")) {
+        try {
+            run_power_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--executor")) {
+        try {
+            run_executor_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--scheduler")) {
+        try {
+            run_scheduler_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--packed")) {
+        try {
+            run_packed_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--stream")) {
+        try {
+            run_stream_mode(args, size, num_threads, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (args.is_present("--sweep")) {
+        try {
+            run_sweep_mode(args, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
 
     matmul::Matrix A(size, size);
     matmul::Matrix B(size, size);
@@ -45,6 +974,22 @@ int main(int argc, char** argv) {
     A.fill_matrix();
     B.fill_matrix();
 
+    if (args.is_present("--simulate")) {
+        try {
+            auto levels = simulated_levels(args, info);
+            if (levels.empty()) {
+                zen::log(zen::color::red("No cache levels known, pass sizes: --simulate L1 [L2 [L3]]"));
+                return 1;
+            }
+            run_cache_simulation(levels, A, B, blockSize);
+        }
+        catch (std::exception& e) {
+            zen::log(zen::color::red(e.what()));
+            return 1;
+        }
+        return 0;
+    }
+
     zen::timer t;
     try {  
         t.start();
@@ -62,6 +1007,13 @@ int main(int argc, char** argv) {
         t.stop();
         auto time_recursive = t.duration_string();
 
+        // Auto: planned by the cost model, which has now seen none of the runs above
+        matmul::AutoPlan plan;
+        t.start();
+        matmul::Matrix F = matmul::AutoTuner::instance().multiply(A, B, &plan);
+        t.stop();
+        auto time_auto = t.duration_string();
+
         zen::log(std::format("Matrix Multiplication Performance (size = {}x{}):", size, size));
         zen::log("----------------------------------------");
         zen::log(std::format("{:<25}Time", "Method"));
@@ -69,12 +1021,45 @@ int main(int argc, char** argv) {
         zen::log(std::format("{:<25}{}", "Naive", time_naive));
         zen::log(std::format("{:<25}{}", "Blocked (blockSize=" + std::to_string(blockSize) + ")", time_blocked));
         zen::log(std::format("{:<25}{}", "Recursive", time_recursive));
+        zen::log(std::format("{:<25}{}", "Auto (" + matmul::algorithm_name(plan.algorithm) + ", " +
+                             std::to_string(plan.num_threads) + "t)", time_auto));
+
+        // --wide: int64 output, 32-bit accumulation only where it provably cannot overflow
+        if (args.is_present("--wide")) {
+            bool narrow = matmul::int32_accumulation_safe(A, B, num_threads);
+            t.start();
+            matmul::Matrix64 W = matmul::matmul_blocked_wide(A, B, blockSize, num_threads);
+            t.stop();
+            zen::log(std::format("{:<25}{}", narrow ? "Blocked wide (int32 acc)" : "Blocked wide (int64 acc)",
+                                 t.duration_string()));
+            if (args.is_present("--verify")) {
+                zen::log(std::format("{:<25}", "Blocked wide"),
+                         matmul::freivalds_verify(A, B, W, 10, num_threads) ? zen::color::green("PASS") : zen::color::red("FAIL"));
+            }
+        }
         zen::log("----------------------------------------");
 
+        // --verify [rounds]: Freivalds' O(n^2) check of every result
+        if (args.is_present("--verify")) {
+            auto options = args.get_options("--verify");
+            int rounds = options.empty() ? 10 : std::stoi(options[0]);
+            auto status = [&](const matmul::Matrix& R) {
+                return matmul::freivalds_verify(A, B, R, rounds, num_threads)
+                    ? zen::color::green("PASS") : zen::color::red("FAIL");
+            };
+            zen::log(std::format("Verification (Freivalds, {} rounds):", rounds));
+            zen::log(std::format("{:<25}", "Naive"), status(C));
+            zen::log(std::format("{:<25}", "Blocked"), status(D));
+            zen::log(std::format("{:<25}", "Recursive"), status(E));
+            zen::log(std::format("{:<25}", "Auto"), status(F));
+            zen::log("----------------------------------------");
+        }
+
         zen::log("Cache Information:");
         zen::log(std::format("L1D Size: {} bytes", info.l1d_size));
         zen::log(std::format("Line Size: {} bytes", info.line_size));
         zen::log(std::format("Block Size: {} ints", blockSize));
+        zen::log(std::format("Kernel ISA: {}", matmul::isa_name(matmul::kernels().isa)));
         if (num_threads > 0) {
             zen::log(std::format("Threads Used: {}", num_threads));
         } else {
@@ -1,50 +1,103 @@
 #include "../includes/matrix.hpp"
+#include "../includes/dispatch.hpp"
+#include "../includes/epilogue.hpp"
+#include "../includes/gemv.hpp"
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
 #include <random>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <cassert>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
 namespace matmul {
-    constexpr size_t CACHE_LINE_SIZE = 64;
-    constexpr size_t ALIGNMENT = CACHE_LINE_SIZE / sizeof(int); // 16 ints for 64 bytes
-
-    Matrix::Matrix(int r, int c, bool align) : m_rows(r), m_cols(c) {
+    template <typename T>
+    BasicMatrix<T>::BasicMatrix(int r, int c, bool align) : m_rows(r), m_cols(c), m_aligned(align) {
         if (r <= 0 || c <= 0) {
             throw std::invalid_argument("Matrix dimensions must be positive");
         }
-        m_row_stride = align ? ((c + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT : c;
+        m_row_stride = align ? padded_stride(c) : c;
         m_data.resize(static_cast<size_t>(r) * m_row_stride, 0);
     }
 
-    void Matrix::fill_matrix() {
+    template <typename T>
+    void BasicMatrix<T>::fill_matrix() {
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_int_distribution<> dis(0, 99);
         for (int i = 0; i < m_rows; ++i) {
             for (int j = 0; j < m_cols; ++j) {
-                at(i, j) = dis(gen);
+                at(i, j) = static_cast<T>(dis(gen));
             }
         }
     }
 
-    int Matrix::get_rows() const 
+    template <typename T>
+    void BasicMatrix<T>::resize(int r, int c) {
+        if (r <= 0 || c <= 0) {
+            throw std::invalid_argument("Matrix dimensions must be positive");
+        }
+        m_rows = r;
+        m_cols = c;
+        m_row_stride = m_aligned ? padded_stride(c) : c;
+        m_data.resize(static_cast<size_t>(r) * m_row_stride);
+    }
+
+    template <typename T>
+    size_t BasicMatrix<T>::padded_stride(int cols) {
+        const size_t alignment = std::max<size_t>(CACHE_LINE_SIZE / sizeof(T), 1);
+        return ((cols + alignment - 1) / alignment) * alignment;
+    }
+
+    template <typename T>
+    size_t BasicMatrix<T>::capacity() const {
+        return m_data.capacity();
+    }
+
+    template <typename T>
+    Layout BasicMatrix<T>::layout() const {
+        return m_layout;
+    }
+
+    template <typename T>
+    void BasicMatrix<T>::set_layout(Layout layout) {
+        m_layout = layout;
+    }
+
+    template <typename T>
+    int BasicMatrix<T>::get_rows() const 
     { 
         return m_rows; 
     }
 
-    int Matrix::get_cols() const { 
+    template <typename T>
+    int BasicMatrix<T>::get_cols() const { 
         return m_cols; 
     }
 
-    size_t Matrix::row_stride() const {
+    template <typename T>
+    size_t BasicMatrix<T>::row_stride() const {
         return m_row_stride;
     }
 
-    std::vector<int> Matrix::get_data() const {
-        std::vector<int> result(static_cast<size_t>(m_rows) * m_cols);
+    template <typename T>
+    T* BasicMatrix<T>::data() {
+        return m_data.data();
+    }
+
+    template <typename T>
+    const T* BasicMatrix<T>::data() const {
+        return m_data.data();
+    }
+
+    template <typename T>
+    std::vector<T> BasicMatrix<T>::get_data() const {
+        std::vector<T> result(static_cast<size_t>(m_rows) * m_cols);
         for (int i = 0; i < m_rows; ++i) {
             for (int j = 0; j < m_cols; ++j) {
                 result[i * m_cols + j] = at(i, j);
@@ -53,30 +106,100 @@ namespace matmul {
         return result;
     }
 
-    int& Matrix::at(int i, int j) {
+    template <typename T>
+    T& BasicMatrix<T>::at(int i, int j) {
         if (i < 0 || i >= m_rows || j < 0 || j >= m_cols) {
             throw std::out_of_range("Matrix index out of bounds");
         }
         return m_data[static_cast<size_t>(i) * m_row_stride + j];
     }
 
-    const int& Matrix::at(int i, int j) const {
+    template <typename T>
+    const T& BasicMatrix<T>::at(int i, int j) const {
         if (i < 0 || i >= m_rows || j < 0 || j >= m_cols) {
             throw std::out_of_range("Matrix index out of bounds");
         }
         return m_data[static_cast<size_t>(i) * m_row_stride + j];
     }
 
+    template class BasicMatrix<int>;
+    template class BasicMatrix<std::int64_t>;
+    template class BasicMatrix<std::int8_t>;
+
+    TileOccupancy::TileOccupancy(const Matrix& M, int block_size, int num_threads) {
+        if (block_size <= 0) {
+            throw std::invalid_argument("Block size must be positive");
+        }
+        m_tile_rows = (M.get_rows() + block_size - 1) / block_size;
+        m_tile_cols = (M.get_cols() + block_size - 1) / block_size;
+        m_bits.assign(static_cast<size_t>(m_tile_rows) * m_tile_cols, 0);
+
+        const int tiles = m_tile_rows * m_tile_cols;
+        (void)num_threads;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 16) num_threads(std::max(num_threads, 1))
+        #endif
+        for (int t = 0; t < tiles; ++t) {
+            const int i0 = (t / m_tile_cols) * block_size;
+            const int j0 = (t % m_tile_cols) * block_size;
+            const int i1 = std::min(i0 + block_size, M.get_rows());
+            const int j1 = std::min(j0 + block_size, M.get_cols());
+            bool any = false;
+            for (int i = i0; i < i1 && !any; ++i) {
+                const int* row = M.data() + i * M.row_stride();
+                for (int j = j0; j < j1; ++j) {
+                    if (row[j] != 0) {
+                        any = true;
+                        break;
+                    }
+                }
+            }
+            m_bits[t] = any;
+        }
+    }
+
+    bool TileOccupancy::occupied(int tile_row, int tile_col) const {
+        return m_bits[static_cast<size_t>(tile_row) * m_tile_cols + tile_col] != 0;
+    }
+
+    int TileOccupancy::tile_rows() const {
+        return m_tile_rows;
+    }
+
+    int TileOccupancy::tile_cols() const {
+        return m_tile_cols;
+    }
+
+    size_t TileOccupancy::occupied_count() const {
+        return static_cast<size_t>(std::count(m_bits.begin(), m_bits.end(), 1));
+    }
+
+    // Logical shape of a B operand, honouring Layout::Transposed
+    static int operand_rows(const Matrix& B) {
+        return B.layout() == Layout::Transposed ? B.get_cols() : B.get_rows();
+    }
+
+    static int operand_cols(const Matrix& B) {
+        return B.layout() == Layout::Transposed ? B.get_rows() : B.get_cols();
+    }
+
+    static void require_row_major(const Matrix& B, const char* engine) {
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument(std::string(engine) + " does not support transposed operands");
+        }
+    }
+
     Matrix matmul_naive(const Matrix& A, const Matrix& B) {
-        if (A.get_cols() != B.get_rows()) {
+        if (A.get_cols() != operand_rows(B)) {
             throw std::invalid_argument("Matrix dimensions do not match for multiplication");
         }
-        Matrix result(A.get_rows(), B.get_cols());
+        const bool bt = B.layout() == Layout::Transposed;
+        Matrix result(A.get_rows(), operand_cols(B));
         for (int i = 0; i < A.get_rows(); i++) {
-            for (int j = 0; j < B.get_cols(); j++) {
+            for (int j = 0; j < result.get_cols(); j++) {
                 int sum = 0;
                 for (int k = 0; k < A.get_cols(); k++) {
-                    sum += A.at(i, k) * B.at(k, j);
+                    sum += A.at(i, k) * (bt ? B.at(j, k) : B.at(k, j));
                 }
                 result.at(i, j) = sum;
             }
@@ -84,59 +207,312 @@ namespace matmul {
         return result;
     }
 
-    Matrix matmul_blocked(const Matrix& A, const Matrix& B, int block_size, int num_threads) {
-        if (A.get_cols() != B.get_rows()) {
-            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
-        }
-
-        int n = A.get_rows(); 
-        assert(A.get_cols() == n && B.get_cols() == n && "Optimized for square matrices");
-
-        Matrix C(n, n);
-        const size_t stride_a = A.row_stride();
-        const size_t stride_b = B.row_stride();
-        const size_t stride_c = C.row_stride();
-
-        block_size = std::min(block_size, n);
-        block_size = (block_size / ALIGNMENT) * ALIGNMENT;
+    // Rounds the block size down to whole cache lines, at most the largest dimension
+    static void normalize_block_size(int m, int n, int depth, int& block_size) {
+        block_size = std::min(block_size, std::max({m, n, depth}));
+        block_size = (block_size / static_cast<int>(ALIGNMENT)) * static_cast<int>(ALIGNMENT);
         if (block_size == 0) block_size = ALIGNMENT;
+    }
 
-        // Disable parallelism for small matrices
-        if (n < 512) num_threads = 1;
-
-        
+    // Clamps a thread request to [1, the OpenMP team limit]
+    static int available_threads(int num_threads) {
         #ifdef _OPENMP
         int max_threads = omp_get_max_threads();
         #else
         int max_threads = 4; 
         #endif
         num_threads = std::min(num_threads, max_threads);
-        num_threads = std::max(num_threads, 1); //] at least 1 thread
+        return std::max(num_threads, 1); //] at least 1 thread
+    }
+
+    void normalize_blocking(int m, int n, int depth, int& block_size, int& num_threads,
+                            double occupied_fraction) {
+        normalize_block_size(m, n, depth, block_size);
+        num_threads = available_threads(num_threads);
+        // Serial requests never trigger calibration (forked ranks must not start a team)
+        if (num_threads > 1) {
+            num_threads = parallel_threads(m, n, depth, block_size, num_threads, occupied_fraction);
+        }
+    }
+
+    // Median of several empty parallel regions at the full team size, and the best of
+    // several 64^3 tile kernel calls on cache-resident operands
+    static ParallelCost calibrate_parallel_cost() {
+        ParallelCost cost{0.0, 0.0};
+        #ifdef _OPENMP
+        const int team = omp_get_max_threads();
+        if (team > 1) {
+            std::vector<double> samples;
+            for (int run = 0; run < 15; ++run) {
+                const auto start = std::chrono::steady_clock::now();
+                #pragma omp parallel num_threads(team)
+                {
+                    volatile int sink = omp_get_thread_num();
+                    (void)sink;
+                }
+                samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+            cost.fork_join_ms = samples[samples.size() / 2] / team;
+        }
+        #endif
+
+        const int size = 64;
+        Matrix A(size, size), B(size, size), C(size, size);
+        A.fill_matrix();
+        B.fill_matrix();
+        const TileKernel tile = kernels().blocked_tile;
+        double best_ms = std::numeric_limits<double>::max();
+        for (int run = 0; run < 8; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            tile(A.data(), A.row_stride(), B.data(), B.row_stride(), C.data(), C.row_stride(), size, size, size);
+            best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        cost.tile_flops_per_ms = 2.0 * size * size * size / std::max(best_ms, 1e-6);
+        return cost;
+    }
+
+    const ParallelCost& parallel_cost() {
+        static const ParallelCost cost = calibrate_parallel_cost();
+        return cost;
+    }
+
+    void init() {
+        kernels();
+        parallel_cost();
+    }
+
+    int parallel_threads(int m, int n, int depth, int block_size, int max_threads, double occupied_fraction) {
+        const long tiles = static_cast<long>((m + block_size - 1) / block_size) * ((n + block_size - 1) / block_size);
+        const int cap = static_cast<int>(std::clamp<long>(tiles, 1, std::max(max_threads, 1)));
+        if (cap == 1) return 1;
+        const ParallelCost& cost = parallel_cost();
+        // One C tile: its rows x cols block against the full depth, less the skipped pairs
+        const double tile_ms = 2.0 * std::min(block_size, m) * std::min(block_size, n) * depth *
+                               std::clamp(occupied_fraction, 0.0, 1.0) / cost.tile_flops_per_ms;
+        auto latency_ms = [&](int threads) {
+            const long rounds = (tiles + threads - 1) / threads;
+            return rounds * tile_ms + (threads > 1 ? threads * cost.fork_join_ms : 0.0);
+        };
+        int best = 1;
+        for (int threads = 2; threads <= cap; ++threads) {
+            if (latency_ms(threads) < latency_ms(best)) best = threads;
+        }
+        return best;
+    }
+
+    // Share of (i, k) x (k, j) tile pairs the blocked engines multiply: for every k-block,
+    // occupied A tiles in that column times occupied B tiles in that row
+    static double occupied_fraction(const TileOccupancy& a, const TileOccupancy& b, bool bt) {
+        const int tiles_k = a.tile_cols();
+        const int tiles_n = bt ? b.tile_rows() : b.tile_cols();
+        double pairs = 0;
+        for (int k = 0; k < tiles_k; ++k) {
+            long a_tiles = 0, b_tiles = 0;
+            for (int i = 0; i < a.tile_rows(); ++i) a_tiles += a.occupied(i, k);
+            for (int j = 0; j < tiles_n; ++j) b_tiles += bt ? b.occupied(j, k) : b.occupied(k, j);
+            pairs += static_cast<double>(a_tiles) * b_tiles;
+        }
+        return pairs / (static_cast<double>(a.tile_rows()) * tiles_k * tiles_n);
+    }
+
+    struct NoFinish {
+        template <typename TOut>
+        void operator()(TOut*, size_t, int, int, int, int) const {}
+    };
+
+    // Zeroes the C tile at (i, j) and accumulates every occupied (i, k) x (k, j) tile pair
+    // into it through `tile`, or `tile_bt` for a Layout::Transposed B (int output only)
+    template <typename TOut, typename TileFn>
+    static void blocked_c_tile(const Matrix& A, const Matrix& B, BasicMatrix<TOut>& C, int block_size,
+                               const TileOccupancy& occupied_a, const TileOccupancy& occupied_b,
+                               int i, int j, TileFn tile, TileBtKernel tile_bt) {
+        const bool bt = B.layout() == Layout::Transposed;
+        const int depth = A.get_cols();
+        const int* a = A.data();
+        const int* b = B.data();
+        TOut* c = C.data();
+        const size_t lda = A.row_stride();
+        const size_t ldb = B.row_stride();
+        const size_t ldc = C.row_stride();
+        const int i_max = std::min(i + block_size, C.get_rows());
+        const int j_max = std::min(j + block_size, C.get_cols());
+        // Zero out block in C
+        for (int ii = i; ii < i_max; ++ii) {
+            std::fill(c + ii * ldc + j, c + ii * ldc + j_max, TOut(0));
+        }
+        for (int k = 0; k < depth; k += block_size) {
+            const bool b_occupied = bt ? occupied_b.occupied(j / block_size, k / block_size)
+                                       : occupied_b.occupied(k / block_size, j / block_size);
+            if (!occupied_a.occupied(i / block_size, k / block_size) || !b_occupied) {
+                continue;
+            }
+            int k_max = std::min(k + block_size, depth);
+            if constexpr (std::is_same_v<TOut, int>) {
+                if (bt) {
+                    tile_bt(a + i * lda + k, lda, b + j * ldb + k, ldb, c + i * ldc + j, ldc,
+                            i_max - i, k_max - k, j_max - j);
+                    continue;
+                }
+            }
+            tile(a + i * lda + k, lda, b + k * ldb + j, ldb, c + i * ldc + j, ldc,
+                 i_max - i, k_max - k, j_max - j);
+        }
+    }
+
+    // Tiles C and hands every (i, j, k) block to `tile`, which accumulates into C,
+    // then calls finish(tile, ldc, i, j, rows, cols) once the tile is complete.
+    // Tile pairs where the A or B tile is all zero contribute nothing and are skipped.
+    // A Layout::Transposed B is read through the unit-stride B^T kernel (int output only).
+    template <typename TOut, typename TileFn, typename FinishFn = NoFinish>
+    static void blocked_driver(const Matrix& A, const Matrix& B, BasicMatrix<TOut>& C,
+                               int block_size, int num_threads, TileFn tile, FinishFn finish = {}) {
+        const bool bt = B.layout() == Layout::Transposed;
+        if constexpr (!std::is_same_v<TOut, int>) {
+            require_row_major(B, "Widening blocked multiply");
+        }
+        const int m = A.get_rows();
+        const int n = operand_cols(B);
+        const int depth = A.get_cols();
+        // The team is sized once, after the occupancy scan, so skipped tile pairs count
+        normalize_block_size(m, n, depth, block_size);
+        const TileOccupancy occupied_a(A, block_size, available_threads(num_threads));
+        const TileOccupancy occupied_b(B, block_size, available_threads(num_threads));
+        normalize_blocking(m, n, depth, block_size, num_threads,
+                           occupied_fraction(occupied_a, occupied_b, bt));
+
+        TOut* c = C.data();
+        const size_t ldc = C.row_stride();
+        const TileBtKernel tile_bt = kernels().blocked_tile_bt;
 
         #ifdef _OPENMP
         #pragma omp parallel for collapse(2) schedule(dynamic) num_threads(num_threads)
         #endif
-        for (int i = 0; i < n; i += block_size) {
+        for (int i = 0; i < m; i += block_size) {
             for (int j = 0; j < n; j += block_size) {
-                // Zero out block in C
-                for (int ii = i; ii < std::min(i + block_size, n); ++ii) {
-                    for (int jj = j; jj < std::min(j + block_size, n); ++jj) {
-                        C.at(ii, jj) = 0;
-                    }
-                }
-                for (int k = 0; k < n; k += block_size) {
-                    int i_max = std::min(i + block_size, n);
-                    int j_max = std::min(j + block_size, n);
-                    int k_max = std::min(k + block_size, n);
-
-                    // Optimized kernel
-                    for (int ii = i; ii < i_max; ++ii) {
-                        for (int kk = k; kk < k_max; ++kk) {
-                            int a_ik = A.at(ii, kk);
-                            for (int jj = j; jj < j_max; ++jj) {
-                                C.at(ii, jj) += a_ik * B.at(kk, jj);
-                            }
+                blocked_c_tile(A, B, C, block_size, occupied_a, occupied_b, i, j, tile, tile_bt);
+                finish(c + i * ldc + j, ldc, i, j, std::min(block_size, m - i), std::min(block_size, n - j));
+            }
+        }
+    }
+
+    BlockedProduct::BlockedProduct(const Matrix& A, const Matrix& B, int block_size, int num_threads)
+        : m_A(A), m_B(B), m_block_size(normalized_block_size(A, B, block_size)),
+          m_occupied_a(A, m_block_size, num_threads), m_occupied_b(B, m_block_size, num_threads),
+          m_kernels(kernels()) {
+        if (A.get_cols() != operand_rows(B)) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+    }
+
+    int BlockedProduct::normalized_block_size(const Matrix& A, const Matrix& B, int block_size) {
+        normalize_block_size(A.get_rows(), operand_cols(B), A.get_cols(), block_size);
+        return block_size;
+    }
+
+    int BlockedProduct::block_size() const {
+        return m_block_size;
+    }
+
+    void BlockedProduct::rows(Matrix& C, int row_begin, int row_end) const {
+        if (C.get_rows() != m_A.get_rows() || C.get_cols() != operand_cols(m_B)) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        row_end = std::min(row_end, C.get_rows());
+        if (row_begin < 0 || row_begin % m_block_size != 0 ||
+            (row_end % m_block_size != 0 && row_end != C.get_rows())) {
+            throw std::invalid_argument("Row range must be aligned to the block size");
+        }
+        for (int i = row_begin; i < row_end; i += m_block_size) {
+            for (int j = 0; j < C.get_cols(); j += m_block_size) {
+                blocked_c_tile(m_A, m_B, C, m_block_size, m_occupied_a, m_occupied_b, i, j,
+                               m_kernels.blocked_tile, m_kernels.blocked_tile_bt);
+            }
+        }
+    }
+
+    Matrix matmul_blocked(const Matrix& A, const Matrix& B, int block_size, int num_threads) {
+        if (A.get_cols() != operand_rows(B)) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        // Vector-like shapes are bandwidth-bound; tiling only adds overhead there
+        if (A.get_rows() == 1 || operand_cols(B) <= SKINNY_MAX_COLS) {
+            normalize_blocking(A.get_rows(), operand_cols(B), A.get_cols(), block_size, num_threads);
+            return matmul_skinny(A, B, num_threads);
+        }
+        Matrix C(A.get_rows(), operand_cols(B));
+        // ISA-specific kernel, selected once at startup
+        blocked_driver(A, B, C, block_size, num_threads, kernels().blocked_tile);
+        return C;
+    }
+
+    Matrix matmul_blocked(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                          const Epilogue& epilogue) {
+        if (A.get_cols() != operand_rows(B)) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        epilogue.validate(A.get_rows(), operand_cols(B));
+        Matrix C(A.get_rows(), operand_cols(B));
+        blocked_driver(A, B, C, block_size, num_threads, kernels().blocked_tile,
+                       [&epilogue](int* tile, size_t ld, int i, int j, int rows, int cols) {
+                           epilogue.apply(tile, ld, i, j, rows, cols);
+                       });
+        return C;
+    }
+
+    Matrix8 matmul_blocked_requantized(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                                       const Epilogue& epilogue, const Requantize& requantize) {
+        require_row_major(B, "Requantized blocked multiply");
+        requantize.validate();
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int m = A.get_rows();
+        const int n = B.get_cols();
+        const int depth = A.get_cols();
+        epilogue.validate(m, n);
+        normalize_block_size(m, n, depth, block_size);
+        const TileOccupancy occupied_a(A, block_size, available_threads(num_threads));
+        const TileOccupancy occupied_b(B, block_size, available_threads(num_threads));
+        normalize_blocking(m, n, depth, block_size, num_threads,
+                           occupied_fraction(occupied_a, occupied_b, false));
+
+        Matrix8 C(m, n);
+        const TileKernel tile = kernels().blocked_tile;
+        const int* a = A.data();
+        const int* b = B.data();
+        const size_t lda = A.row_stride();
+        const size_t ldb = B.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(num_threads)
+        #endif
+        {
+            // int32 accumulators for one tile; only the int8 result reaches C
+            std::vector<int> acc(static_cast<size_t>(block_size) * block_size);
+            const size_t ld = block_size;
+
+            #ifdef _OPENMP
+            #pragma omp for collapse(2) schedule(dynamic)
+            #endif
+            for (int i = 0; i < m; i += block_size) {
+                for (int j = 0; j < n; j += block_size) {
+                    const int rows = std::min(block_size, m - i);
+                    const int cols = std::min(block_size, n - j);
+                    std::fill(acc.begin(), acc.end(), 0);
+                    for (int k = 0; k < depth; k += block_size) {
+                        if (!occupied_a.occupied(i / block_size, k / block_size) ||
+                            !occupied_b.occupied(k / block_size, j / block_size)) {
+                            continue;
                         }
+                        tile(a + i * lda + k, lda, b + k * ldb + j, ldb, acc.data(), ld,
+                             rows, std::min(block_size, depth - k), cols);
+                    }
+                    epilogue.apply(acc.data(), ld, i, j, rows, cols);
+                    for (int ii = 0; ii < rows; ++ii) {
+                        int8_t* out = C.data() + (i + ii) * C.row_stride() + j;
+                        const int* in = acc.data() + ii * ld;
+                        for (int jj = 0; jj < cols; ++jj) out[jj] = requantize(in[jj]);
                     }
                 }
             }
@@ -144,37 +520,137 @@ namespace matmul {
         return C;
     }
 
-    static void matmul_recursive_helper(const Matrix& A, const Matrix& B, Matrix& C, 
-                                       int rA, int cA, int rB, int cB, int rC, int cC, int size) {
-        if (size <= 64) {
-            for (int i = 0; i < size; i++) {
-                for (int j = 0; j < size; j++) {
-                    int sum = 0;
-                    for (int k = 0; k < size; k++) {
-                        sum += A.at(rA + i, cA + k) * B.at(rB + k, cB + j);
-                    }
-                    C.at(rC + i, cC + j) = sum;
-                }
+    void matmul_blocked_into(const Matrix& A, const Matrix& B, Matrix& C, int block_size, int num_threads) {
+        if (A.get_cols() != operand_rows(B) || C.get_rows() != A.get_rows() || C.get_cols() != operand_cols(B)) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        blocked_driver(A, B, C, block_size, num_threads, kernels().blocked_tile);
+    }
+
+    bool int32_accumulation_safe(const Matrix& A, const Matrix& B, int num_threads) {
+        require_row_major(B, "Overflow check");
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        constexpr int64_t limit = std::numeric_limits<int32_t>::max();
+        const int depth = A.get_cols();
+        (void)num_threads;
+
+        std::vector<int64_t> b_row_max(depth, 0);
+        for (int k = 0; k < depth; ++k) {
+            const int* row = B.data() + k * B.row_stride();
+            for (int j = 0; j < B.get_cols(); ++j) {
+                b_row_max[k] = std::max(b_row_max[k], std::abs(static_cast<int64_t>(row[j])));
+            }
+        }
+
+        bool safe = true;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(std::max(num_threads, 1)) reduction(&&:safe)
+        #endif
+        for (int i = 0; i < A.get_rows(); ++i) {
+            const int* row = A.data() + i * A.row_stride();
+            int64_t bound = 0;
+            // Stop as soon as the bound passes the limit so the sum itself cannot overflow
+            for (int k = 0; k < depth && bound <= limit; ++k) {
+                bound += std::abs(static_cast<int64_t>(row[k])) * b_row_max[k];
             }
+            safe = safe && bound <= limit;
+        }
+        return safe;
+    }
+
+    Matrix64 matmul_blocked_wide(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                                 Accumulation mode) {
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        if (mode == Accumulation::Auto) {
+            mode = int32_accumulation_safe(A, B, num_threads) ? Accumulation::Int32 : Accumulation::Int64;
+        }
+
+        Matrix64 C(A.get_rows(), B.get_cols());
+        if (mode == Accumulation::Int64) {
+            blocked_driver(A, B, C, block_size, num_threads, kernels().blocked_tile_wide);
+            return C;
+        }
+
+        // 32-bit fast path, widened on the way out
+        Matrix narrow = matmul_blocked(A, B, block_size, num_threads);
+        for (int i = 0; i < C.get_rows(); ++i) {
+            const int* src = narrow.data() + i * narrow.row_stride();
+            std::copy(src, src + C.get_cols(), C.data() + i * C.row_stride());
+        }
+        return C;
+    }
+
+    // C(m x n) += A(m x depth) * B(depth x n): halve the largest dimension until all
+    // three fit the cutoff; depth halves run one after the other into the same C
+    static void matmul_recursive_helper(const int* a, size_t lda, const int* b, size_t ldb,
+                                        int* c, size_t ldc, int m, int depth, int n, int cutoff,
+                                        TileKernel tile) {
+        if (m <= cutoff && depth <= cutoff && n <= cutoff) {
+            tile(a, lda, b, ldb, c, ldc, m, depth, n);
             return;
         }
-        int half = size / 2;
-        matmul_recursive_helper(A, B, C, rA, cA, rB, cB, rC, cC, half);
-        matmul_recursive_helper(A, B, C, rA, cA + half, rB + half, cB, rC, cC, half);
-        matmul_recursive_helper(A, B, C, rA, cA, rB, cB + half, rC, cC + half, half);
-        matmul_recursive_helper(A, B, C, rA, cA + half, rB + half, cB + half, rC, cC + half, half);
-        matmul_recursive_helper(A, B, C, rA + half, cA, rB, cB, rC + half, cC, half);
-        matmul_recursive_helper(A, B, C, rA + half, cA + half, rB + half, cB, rC + half, cC, half);
-        matmul_recursive_helper(A, B, C, rA + half, cA, rB, cB + half, rC + half, cC + half, half);
-        matmul_recursive_helper(A, B, C, rA + half, cA + half, rB + half, cB + half, rC + half, cC + half, half);
+        if (m >= depth && m >= n) {
+            const int half = m / 2;
+            matmul_recursive_helper(a, lda, b, ldb, c, ldc, half, depth, n, cutoff, tile);
+            matmul_recursive_helper(a + half * lda, lda, b, ldb, c + half * ldc, ldc, m - half, depth, n, cutoff, tile);
+        } else if (n >= depth) {
+            const int half = n / 2;
+            matmul_recursive_helper(a, lda, b, ldb, c, ldc, m, depth, half, cutoff, tile);
+            matmul_recursive_helper(a, lda, b + half, ldb, c + half, ldc, m, depth, n - half, cutoff, tile);
+        } else {
+            const int half = depth / 2;
+            matmul_recursive_helper(a, lda, b, ldb, c, ldc, m, half, n, cutoff, tile);
+            matmul_recursive_helper(a + half, lda, b + half * ldb, ldb, c, ldc, m, depth - half, n, cutoff, tile);
+        }
+    }
+
+    static void recursive_into(const Matrix& A, const Matrix& B, Matrix& C, int cutoff) {
+        matmul_recursive_helper(A.data(), A.row_stride(), B.data(), B.row_stride(), C.data(), C.row_stride(),
+                                A.get_rows(), A.get_cols(), B.get_cols(), cutoff, kernels().blocked_tile);
+    }
+
+    // Fastest leaf for a 256^3 product with the dispatched kernel, best of two runs each
+    static int autotune_recursive_cutoff() {
+        const int size = 256;
+        Matrix A(size, size), B(size, size), C(size, size);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                A.at(i, j) = (i + j) % 7;
+                B.at(i, j) = (i * j) % 5;
+            }
+        }
+        int best_cutoff = 64;
+        double best_time = std::numeric_limits<double>::max();
+        for (int cutoff : {16, 32, 64, 128}) {
+            for (int run = 0; run < 2; ++run) {
+                const auto start = std::chrono::steady_clock::now();
+                recursive_into(A, B, C, cutoff);
+                const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (elapsed < best_time) {
+                    best_time = elapsed;
+                    best_cutoff = cutoff;
+                }
+            }
+        }
+        return best_cutoff;
+    }
+
+    int recursive_cutoff() {
+        static const int cutoff = autotune_recursive_cutoff();
+        return cutoff;
     }
 
-    Matrix matmul_recursive(const Matrix& A, const Matrix& B) {
+    Matrix matmul_recursive(const Matrix& A, const Matrix& B, int cutoff) {
+        require_row_major(B, "matmul_recursive");
         if (A.get_cols() != B.get_rows()) {
             throw std::runtime_error("Matrix dimensions do not match for multiplication");
         }
         Matrix result(A.get_rows(), B.get_cols());
-        matmul_recursive_helper(A, B, result, 0, 0, 0, 0, 0, 0, A.get_rows());
+        recursive_into(A, B, result, cutoff > 0 ? cutoff : recursive_cutoff());
         return result;
     }
-}
\ No newline at end of file
+}
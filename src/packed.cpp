@@ -0,0 +1,184 @@
+#include "../includes/packed.hpp"
+#include "../includes/dispatch.hpp"
+#include <algorithm>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    PackedMatrix::PackedMatrix(const Matrix& B, int block_size) {
+        const bool bt = B.layout() == Layout::Transposed;
+        m_rows = bt ? B.get_cols() : B.get_rows();
+        m_cols = bt ? B.get_rows() : B.get_cols();
+        int threads = 1;
+        normalize_blocking(m_cols, m_cols, m_rows, block_size, threads);
+        m_block_size = block_size;
+
+        const int panels = (m_cols + block_size - 1) / block_size;
+        const int k_blocks = (m_rows + block_size - 1) / block_size;
+        m_panels.assign(static_cast<size_t>(panels) * m_rows * block_size, 0);
+        m_occupied.assign(static_cast<size_t>(k_blocks) * panels, 0);
+
+        const int* b = B.data();
+        const size_t ldb = B.row_stride();
+        for (int p = 0; p < panels; ++p) {
+            const int j0 = p * block_size;
+            const int width = std::min(block_size, m_cols - j0);
+            int* panel = m_panels.data() + static_cast<size_t>(p) * m_rows * block_size;
+            if (bt) {
+                // Stored row j0 + j is logical column j0 + j; copy tile by tile so the
+                // strided writes stay within one block_size x block_size tile
+                for (int k0 = 0; k0 < m_rows; k0 += block_size) {
+                    const int k1 = std::min(k0 + block_size, m_rows);
+                    for (int j = 0; j < width; ++j) {
+                        const int* src = b + (j0 + j) * ldb;
+                        for (int k = k0; k < k1; ++k) panel[static_cast<size_t>(k) * block_size + j] = src[k];
+                    }
+                }
+            } else {
+                for (int k = 0; k < m_rows; ++k) {
+                    std::copy_n(b + k * ldb + j0, width, panel + static_cast<size_t>(k) * block_size);
+                }
+            }
+            for (int k = 0; k < m_rows; ++k) {
+                const int* row = panel + static_cast<size_t>(k) * block_size;
+                if (std::any_of(row, row + width, [](int v) { return v != 0; })) {
+                    m_occupied[static_cast<size_t>(k / block_size) * panels + p] = 1;
+                }
+            }
+        }
+    }
+
+    int PackedMatrix::get_rows() const {
+        return m_rows;
+    }
+
+    int PackedMatrix::get_cols() const {
+        return m_cols;
+    }
+
+    int PackedMatrix::block_size() const {
+        return m_block_size;
+    }
+
+    size_t PackedMatrix::bytes() const {
+        return m_panels.size() * sizeof(int) + m_occupied.size();
+    }
+
+    const int* PackedMatrix::tile(int k, int j) const {
+        const size_t panel = j / m_block_size;
+        return m_panels.data() + (panel * m_rows + k) * m_block_size;
+    }
+
+    bool PackedMatrix::occupied(int k, int j) const {
+        const int panels = (m_cols + m_block_size - 1) / m_block_size;
+        return m_occupied[static_cast<size_t>(k / m_block_size) * panels + j / m_block_size] != 0;
+    }
+
+    Matrix matmul_blocked(const Matrix& A, const PackedMatrix& B, int num_threads) {
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int m = A.get_rows();
+        const int n = B.get_cols();
+        const int depth = A.get_cols();
+        const int block_size = B.block_size();
+        int unused_block = block_size;
+        normalize_blocking(m, n, depth, unused_block, num_threads);
+
+        Matrix C(m, n);
+        const TileKernel tile = kernels().blocked_tile;
+        const int* a = A.data();
+        int* c = C.data();
+        const size_t lda = A.row_stride();
+        const size_t ldc = C.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel for collapse(2) schedule(dynamic) num_threads(num_threads)
+        #endif
+        for (int i = 0; i < m; i += block_size) {
+            for (int j = 0; j < n; j += block_size) {
+                const int rows = std::min(block_size, m - i);
+                const int cols = std::min(block_size, n - j);
+                for (int k = 0; k < depth; k += block_size) {
+                    if (!B.occupied(k, j)) continue;
+                    tile(a + i * lda + k, lda, B.tile(k, j), block_size, c + i * ldc + j, ldc,
+                         rows, std::min(block_size, depth - k), cols);
+                }
+            }
+        }
+        return C;
+    }
+
+    PackCache::PackCache(size_t budget_bytes) : m_budget_bytes(budget_bytes) {}
+
+    // Called with m_mutex held
+    void PackCache::evict(std::list<Entry>::iterator it) {
+        m_used_bytes -= it->packed->bytes();
+        m_index.erase(it->key);
+        m_lru.erase(it);
+    }
+
+    std::shared_ptr<const PackedMatrix> PackCache::get(const Matrix& B, uint64_t version, int block_size) {
+        const Key key{&B, version, block_size};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto found = m_index.find(key); found != m_index.end()) {
+                ++m_hits;
+                m_lru.splice(m_lru.begin(), m_lru, found->second);
+                return found->second->packed;
+            }
+            ++m_misses;
+        }
+
+        // Packing is the expensive part; other callers keep hitting the cache meanwhile
+        auto packed = std::make_shared<const PackedMatrix>(B, block_size);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Another caller may have packed the same key while the lock was released
+        if (auto found = m_index.find(key); found != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, found->second);
+            return found->second->packed;
+        }
+        // Older versions of this matrix at this block size can never be hit again; a newer
+        // one already cached means this pack is the stale one
+        for (auto it = m_lru.begin(); it != m_lru.end();) {
+            auto next = std::next(it);
+            const auto& [matrix, cached_version, cached_block] = it->key;
+            if (matrix == &B && cached_block == block_size) {
+                if (cached_version > version) return packed;
+                evict(it);
+            }
+            it = next;
+        }
+        if (packed->bytes() > m_budget_bytes) return packed; // never fits; do not cache
+        while (m_used_bytes + packed->bytes() > m_budget_bytes) evict(std::prev(m_lru.end()));
+        m_lru.push_front({key, packed});
+        m_index[key] = m_lru.begin();
+        m_used_bytes += packed->bytes();
+        return packed;
+    }
+
+    void PackCache::clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lru.clear();
+        m_index.clear();
+        m_used_bytes = 0;
+    }
+
+    size_t PackCache::used_bytes() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_used_bytes;
+    }
+
+    size_t PackCache::hits() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    size_t PackCache::misses() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+}
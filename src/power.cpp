@@ -0,0 +1,141 @@
+#include "../includes/power.hpp"
+#include "../includes/dispatch.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    static void set_identity(Matrix& M) {
+        for (int i = 0; i < M.get_rows(); ++i) {
+            std::fill(M.data() + i * M.row_stride(), M.data() + (i + 1) * M.row_stride(), 0);
+            M.at(i, i) = 1;
+        }
+    }
+
+    static int highest_bit(uint64_t k) {
+        int bit = 63;
+        while (!(k >> bit)) --bit;
+        return bit;
+    }
+
+    // Left-to-right exponentiation: R = R*R, then R = R*A when the bit is set. `multiply`
+    // writes its product into a separate buffer, which is then swapped into R.
+    template <typename MultiplyFn>
+    static Matrix power_driver(const Matrix& A, uint64_t k, MultiplyFn multiply) {
+        if (A.get_rows() != A.get_cols()) {
+            throw std::invalid_argument("Matrix power requires a square matrix");
+        }
+        if (A.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("Matrix power does not support transposed operands");
+        }
+        Matrix R(A.get_rows(), A.get_cols());
+        if (k == 0) {
+            set_identity(R);
+            return R;
+        }
+        Matrix T(A.get_rows(), A.get_cols());
+        R = A;
+        for (int bit = highest_bit(k) - 1; bit >= 0; --bit) {
+            multiply(R, R, T);
+            std::swap(R, T);
+            if ((k >> bit) & 1) {
+                multiply(R, A, T);
+                std::swap(R, T);
+            }
+        }
+        return R;
+    }
+
+    Matrix matmul_power(const Matrix& A, uint64_t k, int block_size, int num_threads) {
+        return power_driver(A, k, [&](const Matrix& X, const Matrix& Y, Matrix& out) {
+            matmul_blocked_into(X, Y, out, block_size, num_threads);
+        });
+    }
+
+    // out = X * Y mod modulus for operands already reduced to [0, modulus). Each thread
+    // accumulates one tile in its slice of `scratch` and reduces it before the int64
+    // sum of products could overflow.
+    static void multiply_mod(const Matrix& X, const Matrix& Y, Matrix& out, int64_t modulus,
+                             int block_size, int num_threads, std::vector<int64_t>& scratch) {
+        const int n = X.get_rows();
+        const int64_t largest = modulus - 1;
+        const int64_t max_terms = largest == 0 ? std::numeric_limits<int>::max()
+            : (std::numeric_limits<int64_t>::max() - largest) / (largest * largest);
+        const int slice = static_cast<int>(std::min<int64_t>(block_size, std::max<int64_t>(1, max_terms)));
+        const WideTileKernel tile = kernels().blocked_tile_wide;
+        const int* x = X.data();
+        const int* y = Y.data();
+        const size_t ldx = X.row_stride();
+        const size_t ldy = Y.row_stride();
+        const size_t ld = block_size;
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(num_threads)
+        #endif
+        {
+            #ifdef _OPENMP
+            int64_t* acc = scratch.data() + static_cast<size_t>(omp_get_thread_num()) * block_size * block_size;
+            #pragma omp for collapse(2) schedule(dynamic)
+            #else
+            int64_t* acc = scratch.data();
+            #endif
+            for (int i = 0; i < n; i += block_size) {
+                for (int j = 0; j < n; j += block_size) {
+                    const int rows = std::min(block_size, n - i);
+                    const int cols = std::min(block_size, n - j);
+                    auto reduce = [&] {
+                        for (int ii = 0; ii < rows; ++ii) {
+                            for (int jj = 0; jj < cols; ++jj) acc[ii * ld + jj] %= modulus;
+                        }
+                    };
+                    std::fill(acc, acc + static_cast<size_t>(block_size) * block_size, 0);
+                    int64_t terms = 0;
+                    for (int k = 0; k < n; k += slice) {
+                        const int len = std::min(slice, n - k);
+                        if (terms + len > max_terms) {
+                            reduce();
+                            terms = 0;
+                        }
+                        tile(x + i * ldx + k, ldx, y + k * ldy + j, ldy, acc, ld, rows, len, cols);
+                        terms += len;
+                    }
+                    reduce();
+                    for (int ii = 0; ii < rows; ++ii) {
+                        int* row = out.data() + (i + ii) * out.row_stride() + j;
+                        for (int jj = 0; jj < cols; ++jj) row[jj] = static_cast<int>(acc[ii * ld + jj]);
+                    }
+                }
+            }
+        }
+    }
+
+    Matrix matmul_power_mod(const Matrix& A, uint64_t k, int modulus, int block_size, int num_threads) {
+        if (modulus < 1) {
+            throw std::invalid_argument("Modulus must be positive");
+        }
+        const int n = A.get_rows();
+        Matrix reduced = A;
+        for (int i = 0; i < A.get_rows(); ++i) {
+            for (int j = 0; j < A.get_cols(); ++j) {
+                const int64_t residue = A.at(i, j) % modulus;
+                reduced.at(i, j) = static_cast<int>(residue < 0 ? residue + modulus : residue);
+            }
+        }
+        normalize_blocking(n, n, n, block_size, num_threads);
+        // One accumulator tile per thread, allocated once for every product
+        std::vector<int64_t> scratch(static_cast<size_t>(num_threads) * block_size * block_size);
+
+        Matrix R = power_driver(reduced, k, [&](const Matrix& X, const Matrix& Y, Matrix& out) {
+            multiply_mod(X, Y, out, modulus, block_size, num_threads, scratch);
+        });
+        if (k == 0) {
+            for (int i = 0; i < n; ++i) R.at(i, i) %= modulus;
+        }
+        return R;
+    }
+}
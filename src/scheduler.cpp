@@ -0,0 +1,358 @@
+#include "../includes/scheduler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace matmul {
+    // A job further back in line may start ahead of the head this many times
+    static constexpr int MAX_BACKFILL = 8;
+
+    static std::vector<int> all_cpus() {
+        const int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<int> cpus(count);
+        for (int i = 0; i < count; ++i) cpus[i] = i;
+        return cpus;
+    }
+
+    #ifdef __linux__
+    static std::string read_line(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    // Key shared by CPUs in the same NUMA node and L3: "node0|0-15"
+    static std::string domain_key(int cpu) {
+        namespace fs = std::filesystem;
+        const fs::path dir = fs::path("/sys/devices/system/cpu") / ("cpu" + std::to_string(cpu));
+        std::string key;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(dir, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) == 0) key = name;
+        }
+        std::string shared;
+        for (const auto& entry : fs::directory_iterator(dir / "cache", ec)) {
+            if (read_line(entry.path() / "level") == "3") {
+                shared = read_line(entry.path() / "shared_cpu_list");
+            }
+        }
+        return key + "|" + shared;
+    }
+    #endif
+
+    std::vector<std::vector<int>> detect_core_domains() {
+        #ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            std::map<std::string, size_t> index;
+            std::vector<std::vector<int>> domains;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (!CPU_ISSET(cpu, &allowed)) continue;
+                const std::string key = domain_key(cpu);
+                auto [it, inserted] = index.emplace(key, domains.size());
+                if (inserted) domains.emplace_back();
+                domains[it->second].push_back(cpu);
+            }
+            if (!domains.empty()) return domains;
+        }
+        #endif
+        return {all_cpus()};
+    }
+
+    CoreLease::CoreLease(ComputeScheduler* scheduler, std::vector<int> cpus)
+        : m_scheduler(scheduler), m_cpus(std::move(cpus)) {}
+
+    CoreLease::CoreLease(CoreLease&& other) noexcept
+        : m_scheduler(other.m_scheduler), m_cpus(std::move(other.m_cpus)) {
+        other.m_scheduler = nullptr;
+        other.m_cpus.clear();
+    }
+
+    CoreLease& CoreLease::operator=(CoreLease&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_scheduler = other.m_scheduler;
+            m_cpus = std::move(other.m_cpus);
+            other.m_scheduler = nullptr;
+            other.m_cpus.clear();
+        }
+        return *this;
+    }
+
+    CoreLease::~CoreLease() {
+        release();
+    }
+
+    int CoreLease::size() const {
+        return static_cast<int>(m_cpus.size());
+    }
+
+    const std::vector<int>& CoreLease::cpus() const {
+        return m_cpus;
+    }
+
+    int CoreLease::grow(int extra) {
+        return m_scheduler ? m_scheduler->grow(m_cpus, extra) : 0;
+    }
+
+    void CoreLease::release() {
+        if (m_scheduler) m_scheduler->release(m_cpus);
+        m_scheduler = nullptr;
+    }
+
+    // Pins the calling thread to one CPU; a no-op where thread affinity is unavailable
+    static void pin_current_thread(int cpu) {
+        #ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+        #else
+        (void)cpu;
+        #endif
+    }
+
+    Matrix CoreLease::multiply(const Matrix& A, const Matrix& B, int block_size, int max_cores) {
+        if (m_cpus.empty() || !m_scheduler) {
+            throw std::logic_error("CoreLease::multiply needs a granted lease");
+        }
+        // Validates the shapes; B's occupancy and the tile kernels are shared by every panel
+        const BlockedProduct product(A, B, block_size);
+        block_size = product.block_size();
+        const int m = A.get_rows();
+        const int panels = (m + block_size - 1) / block_size;
+        max_cores = std::min(std::max(max_cores, size()), panels);
+        Matrix C(m, B.layout() == Layout::Transposed ? B.get_rows() : B.get_cols());
+
+        std::atomic<int> next_panel{0};
+        std::mutex mutex; // guards running, error and growing m_cpus
+        std::condition_variable done;
+        int running = 0;
+        std::exception_ptr error;
+
+        // Every task posted below finishes before multiply returns, so the references stay valid
+        std::function<void()> work = [&] {
+            try {
+                for (int p = next_panel++; p < panels; p = next_panel++) {
+                    product.rows(C, p * block_size, (p + 1) * block_size);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    const int wanted = std::min(max_cores, panels - next_panel.load()) - size();
+                    if (wanted > 0) {
+                        const int before = size();
+                        for (int added = grow(wanted), k = 0; k < added; ++k) {
+                            ++running;
+                            m_scheduler->run_on(m_cpus[before + k], work);
+                        }
+                    }
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+                next_panel = panels;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0) done.notify_all();
+        };
+
+        // The caller only waits, so its own affinity is left untouched
+        std::unique_lock<std::mutex> lock(mutex);
+        for (size_t k = 0; k < m_cpus.size() && static_cast<int>(k) < panels; ++k) {
+            ++running;
+            m_scheduler->run_on(m_cpus[k], work);
+        }
+        done.wait(lock, [&] { return running == 0; });
+        if (error) std::rethrow_exception(error);
+        return C;
+    }
+
+    class ComputeScheduler::CpuWorker {
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_ready;
+            std::deque<std::function<void()>> m_tasks;
+            bool m_stopping = false;
+            std::thread m_thread; // last, so the queue exists before the thread starts
+
+            void loop() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_ready.wait(lock, [&] { return m_stopping || !m_tasks.empty(); });
+                        if (m_tasks.empty()) return;
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
+                }
+            }
+
+        public:
+            explicit CpuWorker(int cpu) : m_thread([this, cpu] {
+                pin_current_thread(cpu);
+                loop();
+            }) {}
+
+            ~CpuWorker() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_ready.notify_one();
+                m_thread.join();
+            }
+
+            void post(std::function<void()> task) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_tasks.push_back(std::move(task));
+                }
+                m_ready.notify_one();
+            }
+    };
+
+    void ComputeScheduler::run_on(int cpu, std::function<void()> task) {
+        CpuWorker* worker;
+        {
+            std::lock_guard<std::mutex> lock(m_workers_mutex);
+            std::unique_ptr<CpuWorker>& slot = m_workers[cpu];
+            if (!slot) slot = std::make_unique<CpuWorker>(cpu);
+            worker = slot.get();
+        }
+        worker->post(std::move(task));
+    }
+
+    ComputeScheduler::ComputeScheduler(std::vector<std::vector<int>> domains) {
+        std::erase_if(domains, [](const std::vector<int>& d) { return d.empty(); });
+        if (domains.empty()) domains.push_back(all_cpus());
+        m_domains = domains;
+        m_free = std::move(domains);
+        for (const auto& d : m_domains) m_total_cores += static_cast<int>(d.size());
+        m_free_cores = m_total_cores;
+    }
+
+    // Workers drain their queues before joining; leases must not outlive the scheduler
+    ComputeScheduler::~ComputeScheduler() = default;
+
+    ComputeScheduler& ComputeScheduler::instance() {
+        static ComputeScheduler scheduler;
+        return scheduler;
+    }
+
+    int ComputeScheduler::total_cores() const {
+        return m_total_cores;
+    }
+
+    int ComputeScheduler::free_cores() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_free_cores;
+    }
+
+    // Best fit within one domain when possible, so a job shares one L3; otherwise
+    // spread over the domains with the most free CPUs
+    std::vector<int> ComputeScheduler::take(int count) {
+        std::vector<int> cpus;
+        int best = -1;
+        for (int d = 0; d < static_cast<int>(m_free.size()); ++d) {
+            const size_t free = m_free[d].size();
+            if (free >= static_cast<size_t>(count) && (best < 0 || free < m_free[best].size())) best = d;
+        }
+        std::vector<int> order;
+        if (best >= 0) {
+            order.push_back(best);
+        } else {
+            for (int d = 0; d < static_cast<int>(m_free.size()); ++d) order.push_back(d);
+            std::sort(order.begin(), order.end(),
+                      [&](int x, int y) { return m_free[x].size() > m_free[y].size(); });
+        }
+        for (int d : order) {
+            while (static_cast<int>(cpus.size()) < count && !m_free[d].empty()) {
+                cpus.push_back(m_free[d].back());
+                m_free[d].pop_back();
+            }
+        }
+        m_free_cores -= static_cast<int>(cpus.size());
+        return cpus;
+    }
+
+    void ComputeScheduler::give_back(const std::vector<int>& cpus) {
+        for (int cpu : cpus) {
+            for (size_t d = 0; d < m_domains.size(); ++d) {
+                if (std::find(m_domains[d].begin(), m_domains[d].end(), cpu) != m_domains[d].end()) {
+                    m_free[d].push_back(cpu);
+                    break;
+                }
+            }
+        }
+        m_free_cores += static_cast<int>(cpus.size());
+    }
+
+    // Called with m_mutex held: grants every waiter that can start now
+    void ComputeScheduler::dispatch() {
+        for (auto it = m_waiters.begin(); it != m_waiters.end() && m_free_cores > 0;) {
+            Waiter* waiter = *it;
+            const int budget = std::clamp(waiter->wanted, 1, m_total_cores);
+            int grant = budget <= m_free_cores ? budget : 0;
+            if (waiter->latency == LatencyClass::Interactive) grant = std::min(budget, m_free_cores);
+            if (grant > 0) {
+                waiter->cpus = take(grant);
+                waiter->granted = true;
+                for (auto ahead = m_waiters.begin(); ahead != it; ++ahead) ++(*ahead)->skipped;
+                it = m_waiters.erase(it);
+                continue;
+            }
+            // Hold the remaining cores for a waiter that has been passed often enough
+            if (waiter->skipped >= MAX_BACKFILL) break;
+            ++it;
+        }
+        m_changed.notify_all();
+    }
+
+    CoreLease ComputeScheduler::acquire(int wanted, Priority priority, LatencyClass latency) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        Waiter waiter{wanted, priority, latency, m_next_seq++, 0, false, {}};
+        auto pos = std::find_if(m_waiters.begin(), m_waiters.end(),
+                                [&](const Waiter* w) { return w->priority < priority; });
+        m_waiters.insert(pos, &waiter);
+        dispatch();
+        m_changed.wait(lock, [&] { return waiter.granted; });
+        return CoreLease(this, std::move(waiter.cpus));
+    }
+
+    void ComputeScheduler::release(std::vector<int>& cpus) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        give_back(cpus);
+        cpus.clear();
+        dispatch();
+    }
+
+    int ComputeScheduler::grow(std::vector<int>& cpus, int extra) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_waiters.empty() || extra <= 0) return 0;
+        const std::vector<int> more = take(std::min(extra, m_free_cores));
+        cpus.insert(cpus.end(), more.begin(), more.end());
+        return static_cast<int>(more.size());
+    }
+
+    Matrix matmul_scheduled(const Matrix& A, const Matrix& B, int block_size, int num_threads,
+                            Priority priority, LatencyClass latency) {
+        CoreLease lease = ComputeScheduler::instance().acquire(num_threads, priority, latency);
+        return lease.multiply(A, B, block_size, num_threads);
+    }
+}
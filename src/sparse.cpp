@@ -0,0 +1,222 @@
+#include "../includes/sparse.hpp"
+#include "../includes/dispatch.hpp"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    // Shared validation for CSR/CSC: ptr has outer + 1 monotone offsets, idx < inner
+    static void validate_compressed(int outer, int inner, const std::vector<int>& ptr,
+                                    const std::vector<int>& idx, const std::vector<int>& values) {
+        if (outer <= 0 || inner <= 0) {
+            throw std::invalid_argument("Matrix dimensions must be positive");
+        }
+        if (ptr.size() != static_cast<size_t>(outer) + 1 || ptr.front() != 0 ||
+            static_cast<size_t>(ptr.back()) != idx.size() || idx.size() != values.size()) {
+            throw std::invalid_argument("Inconsistent sparse matrix arrays");
+        }
+        for (int i = 0; i < outer; ++i) {
+            if (ptr[i] > ptr[i + 1]) {
+                throw std::invalid_argument("Sparse offsets must be non-decreasing");
+            }
+        }
+        for (int x : idx) {
+            if (x < 0 || x >= inner) {
+                throw std::out_of_range("Sparse index out of bounds");
+            }
+        }
+    }
+
+    static int clamp_threads(int num_threads) {
+        #ifdef _OPENMP
+        num_threads = std::min(num_threads, omp_get_max_threads());
+        #endif
+        return std::max(num_threads, 1);
+    }
+
+    CsrMatrix::CsrMatrix(int rows, int cols, std::vector<int> row_ptr, std::vector<int> col_idx, std::vector<int> values)
+        : m_rows(rows), m_cols(cols), m_row_ptr(std::move(row_ptr)), m_col_idx(std::move(col_idx)), m_values(std::move(values)) {
+        validate_compressed(rows, cols, m_row_ptr, m_col_idx, m_values);
+    }
+
+    CsrMatrix CsrMatrix::from_dense(const Matrix& M) {
+        std::vector<int> row_ptr(1, 0), col_idx, values;
+        for (int i = 0; i < M.get_rows(); ++i) {
+            const int* row = M.data() + i * M.row_stride();
+            for (int j = 0; j < M.get_cols(); ++j) {
+                if (row[j] != 0) {
+                    col_idx.push_back(j);
+                    values.push_back(row[j]);
+                }
+            }
+            row_ptr.push_back(static_cast<int>(col_idx.size()));
+        }
+        return CsrMatrix(M.get_rows(), M.get_cols(), std::move(row_ptr), std::move(col_idx), std::move(values));
+    }
+
+    Matrix CsrMatrix::to_dense() const {
+        Matrix M(m_rows, m_cols);
+        for (int i = 0; i < m_rows; ++i) {
+            for (int p = m_row_ptr[i]; p < m_row_ptr[i + 1]; ++p) {
+                M.at(i, m_col_idx[p]) = m_values[p];
+            }
+        }
+        return M;
+    }
+
+    int CsrMatrix::get_rows() const { return m_rows; }
+    int CsrMatrix::get_cols() const { return m_cols; }
+    size_t CsrMatrix::nnz() const { return m_values.size(); }
+    const std::vector<int>& CsrMatrix::row_ptr() const { return m_row_ptr; }
+    const std::vector<int>& CsrMatrix::col_idx() const { return m_col_idx; }
+    const std::vector<int>& CsrMatrix::values() const { return m_values; }
+
+    CscMatrix::CscMatrix(int rows, int cols, std::vector<int> col_ptr, std::vector<int> row_idx, std::vector<int> values)
+        : m_rows(rows), m_cols(cols), m_col_ptr(std::move(col_ptr)), m_row_idx(std::move(row_idx)), m_values(std::move(values)) {
+        validate_compressed(cols, rows, m_col_ptr, m_row_idx, m_values);
+    }
+
+    CscMatrix CscMatrix::from_dense(const Matrix& M) {
+        std::vector<int> col_ptr(1, 0), row_idx, values;
+        for (int j = 0; j < M.get_cols(); ++j) {
+            for (int i = 0; i < M.get_rows(); ++i) {
+                int v = M.at(i, j);
+                if (v != 0) {
+                    row_idx.push_back(i);
+                    values.push_back(v);
+                }
+            }
+            col_ptr.push_back(static_cast<int>(row_idx.size()));
+        }
+        return CscMatrix(M.get_rows(), M.get_cols(), std::move(col_ptr), std::move(row_idx), std::move(values));
+    }
+
+    Matrix CscMatrix::to_dense() const {
+        Matrix M(m_rows, m_cols);
+        for (int j = 0; j < m_cols; ++j) {
+            for (int p = m_col_ptr[j]; p < m_col_ptr[j + 1]; ++p) {
+                M.at(m_row_idx[p], j) = m_values[p];
+            }
+        }
+        return M;
+    }
+
+    int CscMatrix::get_rows() const { return m_rows; }
+    int CscMatrix::get_cols() const { return m_cols; }
+    size_t CscMatrix::nnz() const { return m_values.size(); }
+    const std::vector<int>& CscMatrix::col_ptr() const { return m_col_ptr; }
+    const std::vector<int>& CscMatrix::row_idx() const { return m_row_idx; }
+    const std::vector<int>& CscMatrix::values() const { return m_values; }
+
+    Matrix random_sparse(int rows, int cols, double density) {
+        if (density < 0.0 || density > 1.0) {
+            throw std::invalid_argument("Density must be in [0, 1]");
+        }
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::bernoulli_distribution keep(density);
+        std::uniform_int_distribution<> dis(1, 99);
+        Matrix M(rows, cols);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                if (keep(gen)) M.at(i, j) = dis(gen);
+            }
+        }
+        return M;
+    }
+
+    // Row ranges [panels[p], panels[p + 1]) with about `target` non-zeros each
+    static std::vector<int> nnz_balanced_panels(const std::vector<int>& row_ptr, int rows, size_t target) {
+        std::vector<int> panels(1, 0);
+        for (int i = 0; i < rows; ++i) {
+            if (static_cast<size_t>(row_ptr[i + 1] - row_ptr[panels.back()]) >= target) {
+                panels.push_back(i + 1);
+            }
+        }
+        if (panels.back() != rows) panels.push_back(rows);
+        return panels;
+    }
+
+    Matrix matmul_spmm(const CsrMatrix& A, const Matrix& B, int block_cols, int num_threads) {
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("matmul_spmm does not support transposed operands");
+        }
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int m = A.get_rows();
+        const int n = B.get_cols();
+        Matrix C(m, n);
+        num_threads = clamp_threads(num_threads);
+        block_cols = std::max(static_cast<int>(ALIGNMENT), std::min(block_cols, n));
+
+        // A few panels per thread so dynamic scheduling can even out the tail
+        const size_t target = std::max<size_t>(A.nnz() / (static_cast<size_t>(num_threads) * 4), 1);
+        const std::vector<int> panels = nnz_balanced_panels(A.row_ptr(), m, target);
+        const int num_panels = static_cast<int>(panels.size()) - 1;
+
+        const AxpyKernel axpy = kernels().axpy;
+        const int* row_ptr = A.row_ptr().data();
+        const int* col_idx = A.col_idx().data();
+        const int* values = A.values().data();
+        const int* b = B.data();
+        int* c = C.data();
+        const size_t ldb = B.row_stride();
+        const size_t ldc = C.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+        #endif
+        for (int p = 0; p < num_panels; ++p) {
+            for (int j = 0; j < n; j += block_cols) {
+                const int width = std::min(block_cols, n - j);
+                for (int i = panels[p]; i < panels[p + 1]; ++i) {
+                    int* c_row = c + i * ldc + j;
+                    for (int q = row_ptr[i]; q < row_ptr[i + 1]; ++q) {
+                        axpy(c_row, b + col_idx[q] * ldb + j, values[q], width);
+                    }
+                }
+            }
+        }
+        return C;
+    }
+
+    Matrix matmul_spmm(const CscMatrix& A, const Matrix& B, int block_cols, int num_threads) {
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("matmul_spmm does not support transposed operands");
+        }
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int n = B.get_cols();
+        Matrix C(A.get_rows(), n);
+        num_threads = clamp_threads(num_threads);
+        block_cols = std::max(static_cast<int>(ALIGNMENT), std::min(block_cols, n));
+
+        const AxpyKernel axpy = kernels().axpy;
+        const int* col_ptr = A.col_ptr().data();
+        const int* row_idx = A.row_idx().data();
+        const int* values = A.values().data();
+        const int* b = B.data();
+        int* c = C.data();
+        const size_t ldb = B.row_stride();
+        const size_t ldc = C.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+        #endif
+        for (int j = 0; j < n; j += block_cols) {
+            const int width = std::min(block_cols, n - j);
+            for (int k = 0; k < A.get_cols(); ++k) {
+                const int* b_row = b + k * ldb + j;
+                for (int q = col_ptr[k]; q < col_ptr[k + 1]; ++q) {
+                    axpy(c + row_idx[q] * ldc + j, b_row, values[q], width);
+                }
+            }
+        }
+        return C;
+    }
+}
@@ -0,0 +1,80 @@
+#include "../includes/streaming.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace matmul {
+    StreamingMatmul::StreamingMatmul(const Matrix& B, PanelCallback on_panel, int block_size,
+                                     int num_threads, size_t max_queued)
+        : m_packed(B, block_size), m_on_panel(std::move(on_panel)), m_num_threads(num_threads),
+          m_max_queued(std::max<size_t>(max_queued, 1)) {
+        if (!m_on_panel) {
+            throw std::invalid_argument("Streaming multiply needs a panel callback");
+        }
+        m_worker = std::thread(&StreamingMatmul::worker_loop, this);
+    }
+
+    StreamingMatmul::~StreamingMatmul() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_changed.notify_all();
+        m_worker.join();
+    }
+
+    int StreamingMatmul::rows_pushed() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_rows_pushed;
+    }
+
+    void StreamingMatmul::push(Matrix rows) {
+        if (rows.get_cols() != m_packed.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [&] { return m_error || m_queue.size() < m_max_queued; });
+        if (m_error) std::rethrow_exception(m_error);
+        const int first_row = m_rows_pushed;
+        m_rows_pushed += rows.get_rows();
+        m_queue.push_back({first_row, std::move(rows)});
+        lock.unlock();
+        m_changed.notify_all();
+    }
+
+    void StreamingMatmul::finish() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [&] { return m_error || (m_queue.empty() && !m_busy); });
+        if (m_error) std::rethrow_exception(m_error);
+    }
+
+    void StreamingMatmul::worker_loop() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [&] { return m_closed || !m_queue.empty(); });
+            if (m_queue.empty()) return;
+            Panel panel = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            lock.unlock();
+            // A slot opened up for a blocked push()
+            m_changed.notify_all();
+
+            std::exception_ptr error;
+            if (!m_error) {
+                try {
+                    m_on_panel(panel.first_row, matmul_blocked(panel.rows, m_packed, m_num_threads));
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            m_busy = false;
+            if (error && !m_error) m_error = error;
+            lock.unlock();
+            m_changed.notify_all();
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include "../includes/structured.hpp"
+#include "../includes/dispatch.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    static constexpr int UNBOUNDED = std::numeric_limits<int>::max() / 2;
+
+    Band Band::upper_triangular() {
+        return {0, UNBOUNDED};
+    }
+
+    Band Band::lower_triangular() {
+        return {UNBOUNDED, 0};
+    }
+
+    Band Band::banded(int lower, int upper) {
+        if (lower < 0 || upper < 0) {
+            throw std::invalid_argument("Bandwidths must be non-negative");
+        }
+        return {lower, upper};
+    }
+
+    // Non-zero k-range [lo, hi) of row r
+    static int band_lo(const Band& band, int r) {
+        return std::max(0, r - band.lower);
+    }
+
+    static int band_hi(const Band& band, int r, int depth) {
+        return static_cast<int>(std::min<long>(depth, static_cast<long>(r) + band.upper + 1));
+    }
+
+    // Running sum of in-band multiply-adds over block rows: prefix[b] covers rows [0, b)
+    static std::vector<long> flop_prefix(const Band& band, int m, int depth, int block_size) {
+        const int block_rows = (m + block_size - 1) / block_size;
+        std::vector<long> prefix(block_rows + 1, 0);
+        for (int b = 0; b < block_rows; ++b) {
+            long work = 0;
+            for (int r = b * block_size; r < std::min(m, (b + 1) * block_size); ++r) {
+                work += std::max(0, band_hi(band, r, depth) - band_lo(band, r));
+            }
+            prefix[b + 1] = prefix[b] + work;
+        }
+        return prefix;
+    }
+
+    // First block row of thread tid in a team of `team`, so that every thread gets
+    // about the same number of in-band multiply-adds; thread team starts at the end
+    static int partition_start(const std::vector<long>& prefix, int tid, int team) {
+        const int block_rows = static_cast<int>(prefix.size()) - 1;
+        if (tid <= 0) return 0;
+        if (tid >= team) return block_rows;
+        const long target = prefix[block_rows] * tid / team;
+        return static_cast<int>(std::lower_bound(prefix.begin(), prefix.end(), target) - prefix.begin());
+    }
+
+    Matrix matmul_structured(const Matrix& A, const Band& band, const Matrix& B,
+                             int block_size, int num_threads) {
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("matmul_structured does not support transposed operands");
+        }
+        if (A.get_cols() != B.get_rows()) {
+            throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+        }
+        const int m = A.get_rows();
+        const int n = B.get_cols();
+        const int depth = A.get_cols();
+        normalize_blocking(m, n, depth, block_size, num_threads);
+        Matrix C(m, n);
+
+        const std::vector<long> prefix = flop_prefix(band, m, depth, block_size);
+        const int* a = A.data();
+        const int* b = B.data();
+        int* c = C.data();
+        const size_t lda = A.row_stride();
+        const size_t ldb = B.row_stride();
+        const size_t ldc = C.row_stride();
+        const TileKernel tile = kernels().blocked_tile;
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(num_threads)
+        #endif
+        {
+            // Split by the team actually granted, which may be smaller than requested
+            #ifdef _OPENMP
+            const int tid = omp_get_thread_num();
+            const int team = omp_get_num_threads();
+            #else
+            const int tid = 0;
+            const int team = 1;
+            #endif
+            const int first = partition_start(prefix, tid, team);
+            const int last = partition_start(prefix, tid + 1, team);
+            for (int bi = first; bi < last; ++bi) {
+                const int i = bi * block_size;
+                const int i_max = std::min(i + block_size, m);
+                // Union of the rows' k-ranges, rounded out to whole k-blocks
+                const int k_lo = band_lo(band, i) / block_size * block_size;
+                const int k_hi = band_hi(band, i_max - 1, depth);
+                for (int j = 0; j < n; j += block_size) {
+                    const int cols = std::min(block_size, n - j);
+                    for (int k = k_lo; k < k_hi; k += block_size) {
+                        const int k_max = std::min(k + block_size, depth);
+                        // Whole tile inside the band: one call to the tile kernel
+                        if (band_lo(band, i_max - 1) <= k && k_max <= band_hi(band, i, depth)) {
+                            tile(a + i * lda + k, lda, b + k * ldb + j, ldb, c + i * ldc + j, ldc,
+                                 i_max - i, k_max - k, cols);
+                            continue;
+                        }
+                        // Tile straddles the band edge: clip every row to its own range
+                        for (int r = i; r < i_max; ++r) {
+                            const int lo = std::max(k, band_lo(band, r));
+                            const int hi = std::min(k_max, band_hi(band, r, depth));
+                            if (lo < hi) {
+                                tile(a + r * lda + lo, lda, b + lo * ldb + j, ldb, c + r * ldc + j, ldc,
+                                     1, hi - lo, cols);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return C;
+    }
+}
@@ -0,0 +1,78 @@
+#include "../includes/syrk.hpp"
+#include "../includes/dispatch.hpp"
+#include "../includes/transpose.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    // C = X * X^T restricted to one triangle of tiles. Row i of X is column i of X^T,
+    // so every tile is a unit-stride dot-product tile over two row panels of X.
+    static Matrix syrk_rows(const Matrix& X, Triangle triangle, int block_size, int num_threads,
+                            bool mirror) {
+        const int n = X.get_rows();
+        const int depth = X.get_cols();
+        normalize_blocking(n, n, depth, block_size, num_threads);
+        Matrix C(n, n);
+
+        const int tiles = (n + block_size - 1) / block_size;
+        std::vector<std::pair<int, int>> work;
+        work.reserve(static_cast<size_t>(tiles) * (tiles + 1) / 2);
+        for (int ti = 0; ti < tiles; ++ti) {
+            for (int tj = ti; tj < tiles; ++tj) {
+                work.push_back(triangle == Triangle::Upper ? std::make_pair(ti, tj) : std::make_pair(tj, ti));
+            }
+        }
+
+        const int* x = X.data();
+        int* c = C.data();
+        const size_t ldx = X.row_stride();
+        const size_t ldc = C.row_stride();
+        const TileBtKernel tile = kernels().blocked_tile_bt;
+        const int count = static_cast<int>(work.size());
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+        #endif
+        for (int w = 0; w < count; ++w) {
+            const int i = work[w].first * block_size;
+            const int j = work[w].second * block_size;
+            const int rows = std::min(block_size, n - i);
+            const int cols = std::min(block_size, n - j);
+            for (int k = 0; k < depth; k += block_size) {
+                tile(x + i * ldx + k, ldx, x + j * ldx + k, ldx, c + i * ldc + j, ldc,
+                     rows, std::min(block_size, depth - k), cols);
+            }
+        }
+
+        // Diagonal tiles were computed whole; now fill or clear the other triangle
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads)
+        #endif
+        for (int i = 0; i < n; ++i) {
+            int* row = c + i * ldc;
+            if (triangle == Triangle::Upper) {
+                for (int j = 0; j < i; ++j) row[j] = mirror ? c[j * ldc + i] : 0;
+            } else {
+                for (int j = i + 1; j < n; ++j) row[j] = mirror ? c[j * ldc + i] : 0;
+            }
+        }
+        return C;
+    }
+
+    Matrix syrk(const Matrix& A, Gram gram, Triangle triangle, int block_size, int num_threads,
+                bool mirror) {
+        if (A.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("syrk does not support transposed operands");
+        }
+        if (gram == Gram::AAt) {
+            return syrk_rows(A, triangle, block_size, num_threads, mirror);
+        }
+        // A^T * A == (A^T) * (A^T)^T; one transpose of A buys unit-stride tiles
+        return syrk_rows(transpose(A, num_threads), triangle, block_size, num_threads, mirror);
+    }
+}
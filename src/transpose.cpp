@@ -0,0 +1,151 @@
+#include "../includes/transpose.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    // 32x32 ints: source and destination leaves together stay well inside L1
+    static constexpr int TRANSPOSE_LEAF = 32;
+    // Below this many elements a subproblem is not worth a task
+    static constexpr long TRANSPOSE_TASK_CUTOFF = 128L * 128L;
+
+    // dst(c, r) = src(r, c) for r in [r0, r1), c in [c0, c1)
+    static void transpose_rec(const int* src, size_t lds, int* dst, size_t ldd,
+                              int r0, int r1, int c0, int c1) {
+        const int rows = r1 - r0;
+        const int cols = c1 - c0;
+        if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF) {
+            for (int r = r0; r < r1; ++r) {
+                for (int c = c0; c < c1; ++c) {
+                    dst[c * ldd + r] = src[r * lds + c];
+                }
+            }
+            return;
+        }
+        const bool spawn = static_cast<long>(rows) * cols > TRANSPOSE_TASK_CUTOFF;
+        if (rows >= cols) {
+            const int mid = r0 + rows / 2;
+            #ifdef _OPENMP
+            #pragma omp task if(spawn)
+            #endif
+            transpose_rec(src, lds, dst, ldd, r0, mid, c0, c1);
+            transpose_rec(src, lds, dst, ldd, mid, r1, c0, c1);
+        } else {
+            const int mid = c0 + cols / 2;
+            #ifdef _OPENMP
+            #pragma omp task if(spawn)
+            #endif
+            transpose_rec(src, lds, dst, ldd, r0, r1, c0, mid);
+            transpose_rec(src, lds, dst, ldd, r0, r1, mid, c1);
+        }
+        #ifdef _OPENMP
+        #pragma omp taskwait
+        #endif
+        (void)spawn;
+    }
+
+    // Swaps block (r0..r1, c0..c1) with its mirror; the block lies strictly above the diagonal
+    static void swap_rec(int* m, size_t ld, int r0, int r1, int c0, int c1) {
+        const int rows = r1 - r0;
+        const int cols = c1 - c0;
+        if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF) {
+            for (int r = r0; r < r1; ++r) {
+                for (int c = c0; c < c1; ++c) {
+                    std::swap(m[r * ld + c], m[c * ld + r]);
+                }
+            }
+            return;
+        }
+        const bool spawn = static_cast<long>(rows) * cols > TRANSPOSE_TASK_CUTOFF;
+        if (rows >= cols) {
+            const int mid = r0 + rows / 2;
+            #ifdef _OPENMP
+            #pragma omp task if(spawn)
+            #endif
+            swap_rec(m, ld, r0, mid, c0, c1);
+            swap_rec(m, ld, mid, r1, c0, c1);
+        } else {
+            const int mid = c0 + cols / 2;
+            #ifdef _OPENMP
+            #pragma omp task if(spawn)
+            #endif
+            swap_rec(m, ld, r0, r1, c0, mid);
+            swap_rec(m, ld, r0, r1, mid, c1);
+        }
+        #ifdef _OPENMP
+        #pragma omp taskwait
+        #endif
+        (void)spawn;
+    }
+
+    // Transposes the diagonal block [lo, hi) x [lo, hi) in place
+    static void inplace_rec(int* m, size_t ld, int lo, int hi) {
+        const int size = hi - lo;
+        if (size <= TRANSPOSE_LEAF) {
+            for (int r = lo; r < hi; ++r) {
+                for (int c = r + 1; c < hi; ++c) {
+                    std::swap(m[r * ld + c], m[c * ld + r]);
+                }
+            }
+            return;
+        }
+        const int mid = lo + size / 2;
+        const bool spawn = static_cast<long>(size) * size > TRANSPOSE_TASK_CUTOFF;
+        #ifdef _OPENMP
+        #pragma omp task if(spawn)
+        #endif
+        inplace_rec(m, ld, lo, mid);
+        #ifdef _OPENMP
+        #pragma omp task if(spawn)
+        #endif
+        inplace_rec(m, ld, mid, hi);
+        swap_rec(m, ld, lo, mid, mid, hi);
+        #ifdef _OPENMP
+        #pragma omp taskwait
+        #endif
+        (void)spawn;
+    }
+
+    Matrix transpose(const Matrix& M, int num_threads) {
+        Matrix T(M.get_cols(), M.get_rows());
+        const int* src = M.data();
+        int* dst = T.data();
+        const size_t lds = M.row_stride();
+        const size_t ldd = T.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(std::max(num_threads, 1))
+        #pragma omp single
+        #endif
+        transpose_rec(src, lds, dst, ldd, 0, M.get_rows(), 0, M.get_cols());
+        (void)num_threads;
+        return T;
+    }
+
+    void transpose_inplace(Matrix& M, int num_threads) {
+        if (M.get_rows() != M.get_cols()) {
+            throw std::invalid_argument("In-place transpose requires a square matrix");
+        }
+        int* m = M.data();
+        const size_t ld = M.row_stride();
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(std::max(num_threads, 1))
+        #pragma omp single
+        #endif
+        inplace_rec(m, ld, 0, M.get_rows());
+        (void)num_threads;
+    }
+
+    Matrix transposed_operand(const Matrix& B, int num_threads) {
+        if (B.layout() != Layout::RowMajor) {
+            throw std::invalid_argument("Operand is already transposed");
+        }
+        Matrix T = transpose(B, num_threads);
+        T.set_layout(Layout::Transposed);
+        return T;
+    }
+}
@@ -0,0 +1,126 @@
+#include "../includes/verify.hpp"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace matmul {
+    // y = M * x modulo 2^bits(U), rows split across threads
+    template <typename T, typename U>
+    static void matvec_wrapping(const BasicMatrix<T>& M, const std::vector<U>& x, std::vector<U>& y, int num_threads) {
+        const int rows = M.get_rows();
+        const int cols = M.get_cols();
+        const size_t stride = M.row_stride();
+        const T* data = M.data();
+        (void)num_threads;
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(num_threads)
+        #endif
+        for (int i = 0; i < rows; ++i) {
+            const T* row = data + static_cast<size_t>(i) * stride;
+            U sum = 0;
+            for (int j = 0; j < cols; ++j) {
+                sum += static_cast<U>(row[j]) * x[j];
+            }
+            y[i] = sum;
+        }
+    }
+
+    // y = M^T * x modulo 2^bits(U), for a Layout::Transposed B whose storage is B^T;
+    // column panels are split across threads so every row is read with unit stride
+    template <typename U>
+    static void matvec_transposed_wrapping(const Matrix& M, const std::vector<U>& x, std::vector<U>& y,
+                                           int num_threads) {
+        const int rows = M.get_rows();
+        const int cols = M.get_cols();
+        const size_t stride = M.row_stride();
+        const int* data = M.data();
+        constexpr int PANEL = 256;
+        (void)num_threads;
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(num_threads)
+        #endif
+        for (int j0 = 0; j0 < cols; j0 += PANEL) {
+            const int j_max = std::min(j0 + PANEL, cols);
+            std::fill(y.begin() + j0, y.begin() + j_max, U(0));
+            for (int i = 0; i < rows; ++i) {
+                const int* row = data + static_cast<size_t>(i) * stride;
+                for (int j = j0; j < j_max; ++j) {
+                    y[j] += static_cast<U>(row[j]) * x[i];
+                }
+            }
+        }
+    }
+
+    template <typename U, typename TC>
+    static bool freivalds_rounds(const Matrix& A, const Matrix& B, const BasicMatrix<TC>& C,
+                                 int rounds, int num_threads, uint64_t seed) {
+        // A Layout::Transposed B stores B^T: its logical shape is the storage shape swapped
+        const bool bt = B.layout() == Layout::Transposed;
+        const int b_rows = bt ? B.get_cols() : B.get_rows();
+        const int b_cols = bt ? B.get_rows() : B.get_cols();
+        if (A.get_cols() != b_rows || C.get_rows() != A.get_rows() || C.get_cols() != b_cols) {
+            throw std::invalid_argument("Matrix dimensions do not match for verification");
+        }
+        if (rounds <= 0) {
+            throw std::invalid_argument("Verification needs at least one round");
+        }
+        num_threads = std::max(num_threads, 1);
+
+        if (seed == 0) seed = std::random_device{}();
+        std::mt19937_64 gen(seed);
+        std::bernoulli_distribution coin(0.5);
+
+        std::vector<U> r(b_cols);
+        std::vector<U> br(b_rows);
+        std::vector<U> abr(A.get_rows());
+        std::vector<U> cr(C.get_rows());
+        for (int round = 0; round < rounds; ++round) {
+            for (auto& v : r) v = coin(gen) ? 1 : 0;
+            if (bt) {
+                matvec_transposed_wrapping(B, r, br, num_threads);
+            } else {
+                matvec_wrapping(B, r, br, num_threads);
+            }
+            matvec_wrapping(A, br, abr, num_threads);
+            matvec_wrapping(C, r, cr, num_threads);
+            if (abr != cr) return false;
+        }
+        return true;
+    }
+
+    bool freivalds_verify(const Matrix& A, const Matrix& B, const Matrix& C,
+                          int rounds, int num_threads, uint64_t seed) {
+        return freivalds_rounds<uint32_t>(A, B, C, rounds, num_threads, seed);
+    }
+
+    bool freivalds_verify(const Matrix& A, const Matrix& B, const Matrix64& C,
+                          int rounds, int num_threads, uint64_t seed) {
+        return freivalds_rounds<uint64_t>(A, B, C, rounds, num_threads, seed);
+    }
+
+    PeriodicVerifier::PeriodicVerifier(int every_n, int rounds, int num_threads)
+        : m_every_n(every_n), m_rounds(rounds), m_num_threads(num_threads) {
+        if (every_n <= 0) {
+            throw std::invalid_argument("Verification period must be positive");
+        }
+    }
+
+    bool PeriodicVerifier::check(const Matrix& A, const Matrix& B, const Matrix& C) {
+        uint64_t call = m_calls.fetch_add(1, std::memory_order_relaxed);
+        if (call % static_cast<uint64_t>(m_every_n) != 0) return false;
+        if (!freivalds_verify(A, B, C, m_rounds, m_num_threads)) {
+            throw std::runtime_error("Matrix product failed Freivalds verification");
+        }
+        return true;
+    }
+
+    uint64_t PeriodicVerifier::calls() const {
+        return m_calls.load(std::memory_order_relaxed);
+    }
+}